@@ -0,0 +1,61 @@
+/**
+ * @file lad_autotune.hpp
+ * @author Jose Cappelletto (cappelletto@gmail.com)
+ * @brief Startup calibration of the window filter strategy of the Landing Area Detection (lad) algorithm
+ * @version 0.1
+ * @date 2024-03-18
+ * @details The fastest window engine and tile size depend on the kernel size, the density of valid data and the
+ * machine. They are measured once on a sample of the input and stored in a small YAML file, so later runs with the
+ * same (kernel size, density bucket, machine) reuse the choice without measuring again
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef _LAD_AUTOTUNE_HPP_
+#define _LAD_AUTOTUNE_HPP_
+
+#include "headers.h"
+#include "lad_enum.hpp"
+#include "lad_window.hpp"
+
+namespace lad
+{
+    /**
+     * @brief Conditions a calibration is valid for
+     *
+     */
+    typedef struct autotuneKey_
+    {
+        std::string machine; //!< Machine signature, see getMachineSignature
+        int kernelPixels;    //!< Number of pixels of the (unrotated) vehicle footprint
+        int densityBucket;   //!< Ratio of valid pixels of the calibration sample, in 10% steps [0, 9]
+        int nHeadings;       //!< Number of headings of the run, the moment table is shared by all of them
+        bool batched;        //!< True if the moment engine evaluates every heading in a single pass
+    } AutotuneKey;
+
+    /**
+     * @brief Strategy selected by the calibration
+     *
+     */
+    typedef struct autotuneChoice_
+    {
+        WindowEngine windowEngine; //!< Window filter engine (ENGINE_MOMENTS | ENGINE_GATHER)
+        int tileSize;              //!< Side [px] of the output tiles, zero for complete rows
+        double seconds;            //!< Time [s] of the selected strategy on the calibration sample, per heading
+        bool cached;               //!< True if the choice was read from the cache file instead of measured
+    } AutotuneChoice;
+
+    std::string getMachineSignature();           // Host name, number of OpenMP threads and SIMD instruction set
+    int getDensityBucket(long nValid, long nPixels); // 10% bucket [0, 9] of the ratio of valid pixels
+
+    int readAutotuneCache(const std::string &file, const AutotuneKey &key, AutotuneChoice &choice);        // Look up a calibration in the cache file
+    int writeAutotuneCache(const std::string &file, const AutotuneKey &key, const AutotuneChoice &choice); // Add (or replace) a calibration in the cache file
+
+    cv::Rect getAutotuneSample(const ValidIndex &index, int kernelPixels); // Region of the raster used for the calibration, densest valid square
+    int benchmarkWindowStrategies(const cv::Mat &sample, double nodata, const std::vector<KernelFootprint> &windows, const KernelFootprint &gatherWindow,
+                                  double sx, double sy, bool batched, AutotuneChoice &choice,
+                                  std::vector<AutotuneChoice> *trials = nullptr); // Measure every strategy, keep the fastest
+}
+
+#endif // _LAD_AUTOTUNE_HPP_
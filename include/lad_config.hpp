@@ -56,6 +56,18 @@ namespace lad
         double heightThreshold;      // critical height [m] to separate Low Protrusions from High Protrusions
         double slopeThreshold;       // critical slope [deg]
         FilterType slopeAlgorithm;   // enum identifying slope calculation algorithm (FILTER_SLOPE | FILTER_CONVEX_SLOPE)
+        WindowEngine windowEngine;   // enum identifying the window filter evaluation engine (ENGINE_MOMENTS | ENGINE_GATHER)
+        bool hullSweep;              // reuse the convex hull candidates between neighbouring windows (FILTER_CONVEX_SLOPE). Default: true
+        HullSolver hullSolver;       // enum identifying the convex hull plane solver (HULL_ENVELOPE | HULL_CGAL)
+        std::string planeCache;      // path prefix of the per-heading plane coefficient layers reused between runs. Empty to disable. Default: ""
+        int pointBudget;             // max number of points gathered per window by the plane-fit filters, the footprint is subsampled on a regular grid beyond it. Zero to disable. Default: 0
+        int tileSize;                // side [px] of the output tiles scheduled by the window filters. Zero for complete rows. Default: 64
+        double slopeScreening;       // guard band [deg] of the two-tier convex slope screening, the hull slope is only evaluated near slopeThreshold. Zero to disable. Default: 0
+        bool exclusionGating;        // skip the slope & measurability windows of pixels already excluded by missing data (C1). Default: false
+        bool measurability;          // compute the measurability (X1) and final measurability (M4) maps of every heading, and their blend. Default: false
+        double quantizationStep;     // elevation step [m] the input bathymetry is quantised to (exact integer moments, int16/int32 export). Zero to disable. Default: 0
+        bool autotune;               // measure (or read from autotuneCache) the fastest window engine & tile size at startup, overriding both. Default: false
+        std::string autotuneCache;   // path of the YAML file that stores the autotune calibrations. Default: ".lad_autotune.yaml"
         double groundThreshold;      // min. height [m] to consider a protrusion
         double protrusionSize;       // min. planar size [m] to consider a protrusion
         float alphaShapeRadius;      // radius [m] of alphaShape contour detection
@@ -17,6 +17,8 @@
 #include "geotiff.hpp"
 #include "lad_layer.hpp"
 #include "lad_processing.hpp"
+#include "lad_window.hpp"
+#include "lad_autotune.hpp"
 #include "lad_enum.hpp"
 #include "lad_config.hpp"
 #include "helper.h"
@@ -44,7 +46,22 @@ namespace lad
     private:
         int currentAvailableID;
         std::map <std::string, std::shared_ptr<Layer>> mapLayers;
-        cv::Mat roi_image;      // binary mask that will contain the noData validity mask
+        std::map <std::string, std::string> hullCandidates; // raster layer -> layer with its upper hull candidate bitmap
+        std::map <std::pair<std::string, std::string>, std::string> planeLayers; // (raster, kernel) layers -> layer with their plane coefficients
+        std::map <std::string, std::shared_ptr<MomentTable>> momentTables;         // raster layer -> moment table, shared by every heading
+        std::map <std::string, std::shared_ptr<SensorFootprint>> sensorFootprints; // raster layer -> geotech sensor footprint, shared by every heading
+        std::map <std::string, std::shared_ptr<ValidIndex>> validIndexes;           // raster layer -> valid pixel runs, shared by every filter and heading
+        std::map <std::string, uint64_t> rasterHashes;                              // raster layer -> hash of its samples & georeference (plane cache identity)
+
+        cv::Mat getPlaneData(std::string raster, std::string kernel); // plane coefficients of (raster, kernel), empty if not available
+        KernelFootprint getWindowFootprint(std::shared_ptr<RasterLayer> apSrc, std::shared_ptr<KernelLayer> apKernel, double sx, double sy,
+                                           std::vector<int> filters); // kernel window, subsampled to the point budget for the plane-fit filters
+        std::shared_ptr<MomentTable> getMomentTable(std::shared_ptr<RasterLayer> apSrc);            // moment table of the raster, built on first use
+        std::shared_ptr<ValidIndex> getValidIndex(std::shared_ptr<RasterLayer> apSrc);              // valid pixel index of the raster, built on first use (readTIFF)
+        uint64_t getRasterHash(std::shared_ptr<RasterLayer> apSrc);                                  // hash of the raster samples & georeference, computed on first use
+        std::shared_ptr<SensorFootprint> getSensorFootprint(std::shared_ptr<RasterLayer> apSrc, double sx, double sy); // geotech sensor offsets for the raster, built on first use
+        cv::Mat getCandidateMask(std::shared_ptr<RasterLayer> apSrc, std::shared_ptr<RasterLayer> apMask);    // ROI of the window filters, empty if it excludes no valid pixel
+        void reportSlopePrecision(std::string raster, std::string kernel, std::string slope);                // log the slope deviation against the double precision fit
 
     public:
         Pipeline() //!< Default contructor
@@ -53,6 +70,7 @@ namespace lad
             verbosity = NO_VERBOSE;
             currentAvailableID = 0;
             useNodataMask = false;
+            parameters = getDefaultParams();
         }
 
         ~Pipeline()
@@ -111,6 +129,7 @@ namespace lad
         int uploadData(std::string name, void *data); // uploads data into a layer identified by its name
 
         int copyMask (std::string src, std::string dst); // propagates rasterMask from src to dst
+        int padLayer (std::string raster, std::string kernel); // surrounds a raster layer with a NODATA halo covering any heading of the kernel
         int maskLayer(std::string src, std::string mask, std::string dst, int useRotated = true); // apply mask to raster layer src and store it in dst layer
         int rotateLayer(std::string src, double angle); // rotate a kernel layer a given angle
         
@@ -121,10 +140,20 @@ namespace lad
         int computeExclusionMap(std::string src, std::string kernel, std::string dst);
         int computeMeanSlopeMap(std::string src, std::string kernel, std::string mask, std::string dst);
         int computeConvexSlopeMap(std::string src, std::string kernel, std::string mask, std::string dst);
+        int computeScreenedSlopeMap(std::string src, std::string kernel, std::string mask, std::string dst, int filtertype, double threshold); // slope map exact only near the threshold
         int computeMeasurabilityMap(std::string raster, std::string kernel, std::string mask, std::string dst);
+        int computeSlopeMeasurabilityMap(std::string raster, std::string kernel, std::string mask, std::string slope, std::string measurability, std::string plane = ""); // mean slope and measurability maps from a single fused pass
+        int computePlaneLayer(std::string raster, std::string kernel, std::string mask, std::string dst); // per-pixel fitting plane coefficients, reused by later window filters
+        int computeTerrainDescriptorMaps(std::string raster, std::string kernel, std::string mask, std::string suffix = ""); // slope, TRI, TPI, roughness and curvature from a single fused pass
+        int loadPlaneLayer(std::string raster, std::string kernel, std::string file, std::string dst);    // read plane coefficients exported by a previous run
+        std::string getPlaneCacheTag(std::string raster, std::string kernel);                          // identity of the plane coefficients of (raster, kernel), part of their cache file name
+        int autotuneWindowFilter(std::string raster, std::string kernel, std::vector<double> headings, AutotuneChoice *result = nullptr); // fastest window engine & tile size, measured or cached
         int lowpassFilter      (std::string src, std::string kernel, std::string mask, std::string dst); // apply lowpass filter to input raster Layer and stores the resulting raster in dst Layer
-        int applyWindowFilter  (std::string src, std::string kernel, std::string mask, std::string dst, int filtertype);
+        int applyWindowFilter  (std::string src, std::string kernel, std::string mask, std::string dst, int filtertype, double screenThreshold = NAN);
+        int applyWindowFilter  (std::string src, std::vector<std::string> kernels, std::string mask, std::vector<std::string> dst, int filtertype); // heading-batched filter, one output layer per kernel
+        int applyWindowFilter  (std::string src, std::string kernel, std::string mask, std::map<int, std::string> outputs); // fused filter, one output layer per filter type, single gather & fit per pixel
         int computeHeight      (std::string src, std::string filt, std::string dst);
+        int computeHullCandidates (std::string src, std::string upper, std::string lower); // heading independent convex hull candidate bitmaps of a raster layer
 
         int computeBlendMeasurability(std::string src1, std::string src2, std::string dst);
         int computeLandabilityMap(std::string src1, std::string src2, std::string src3, std::string dst);
@@ -18,12 +18,43 @@
 
 #define SENSOR_RANGE 0.1
 
+// Offset of the upper envelope query point across the pixel grid diagonal, so its facet is unique (see computeConvexHullPlane).
+// The CGAL reference solver keeps the plain (0.0001, 0.0001) query point
+#define ENVELOPE_QUERY_NUDGE 1e-7
+
+// Element type of the raster layers. Float32 (USE_FLOAT32) halves the memory traffic of every pass over the rasters,
+// while the window reductions (moments, point clouds, blending) still accumulate in double
+#ifdef USE_FLOAT32
+#define RASTER_TYPE CV_32FC1
+#define RASTER_DEPTH CV_32F
+#else
+#define RASTER_TYPE CV_64FC1
+#define RASTER_DEPTH CV_64F
+#endif
+
+// NODATA value of the floating point raster layers. NaN (USE_NAN_NODATA) propagates through the layer arithmetic, so
+// invalid samples do not need a separate mask or sentinel test; the sentinel (DEFAULT_NODATA_VALUE) is only restored
+// when the layers are exported (RasterLayer::writeLayer)
+#ifdef USE_NAN_NODATA
+#define RASTER_NODATA (std::numeric_limits<double>::quiet_NaN())
+#else
+#define RASTER_NODATA ((double)DEFAULT_NODATA_VALUE)
+#endif
+
 #include "headers.h"
+#include <limits>
+#include <cmath>
 
 namespace lad{
 
     const std::string DEFAULT_LAYER_NAME = "default_layer_name"; //!< Employed as fallback name during construction time of a new Layer
 
+#ifdef USE_FLOAT32
+    typedef float raster_t; //!< Element type of the raster layers (RASTER_TYPE)
+#else
+    typedef double raster_t; //!< Element type of the raster layers (RASTER_TYPE)
+#endif
+
     /**
      * @brief General constant codes
      * 
@@ -32,9 +63,34 @@ namespace lad{
         DEFAULT_STACK_SIZE  = 100,   //!< Initial Layer vector size (stack or map). Deprecated
         ID_AVAILABLE        = 0,     //!< Flag to indicate ID is available in the LUT
         ID_TAKEN            = 1,      //!< Flag to indicate ID is available in the LUT
-        DEFAULT_NODATA_VALUE= -9999 //!< Default value for NODATA field in raster layers
+        DEFAULT_NODATA_VALUE= -9999,//!< Default value for NODATA field in raster layers
+        PLANE_LAYER_BANDS   = 5,     //!< Number of bands of a plane coefficient layer: a, b, c, d and number of points
+        PLANE_LAYER_FIT     = 1,     //!< Revision of the plane fit of the plane layers (computeFittingPlane), part of their cache identity
+        DEFAULT_TILE_SIZE   = 64,    //!< Default side [px] of the output tiles scheduled by the window filters
+        SUBSAMPLE_VALIDATION_WINDOWS = 256, //!< Number of windows used to validate a subsampled footprint against the full fit
+        AUTOTUNE_SAMPLE_BUDGET = 50000000,  //!< Point visits (windows x kernel pixels) of a gathering run of the calibration sample
+        AUTOTUNE_SAMPLE_MIN = 64,           //!< Minimum side [px] of the calibration sample
+        AUTOTUNE_SAMPLE_MAX = 512,          //!< Maximum side [px] of the calibration sample
+        AUTOTUNE_REPEATS = 2                //!< Runs of every candidate strategy, the fastest one is kept
     };
 
+    /**
+     * @brief Check if a raster sample is NODATA. With USE_NAN_NODATA every floating point layer uses NaN, whatever the
+     * NODATA value of the layer, as NaN never compares equal to itself
+     *
+     * @param value Raster sample
+     * @param nodata NODATA value of the raster layer
+     * @return true if the sample is NODATA
+     */
+    inline bool isNoData(double value, double nodata)
+    {
+#ifdef USE_NAN_NODATA
+        return std::isnan(value);
+#else
+        return value == nodata;
+#endif
+    }
+
     /**
      * @brief General function return codes
      * 
@@ -46,7 +102,8 @@ namespace lad{
         ERROR_GDAL_FAILOPEN     =-3,    //!< GDAL Driver failed to open geoTIFF file
         ERROR_GEOTIFF_EMPTY     =-4,    //!< Provided geoTIFF file is empty
         ERROR_LAYERS_EMPTY      =-5,    //!< No Layer is present in the current stack
-        ERROR_CONTOURS_NOTFOUND =-6     //!< No contour could be found
+        ERROR_CONTOURS_NOTFOUND =-6,    //!< No contour could be found
+        ERROR_NOT_CONVERGED     =-7     //!< Iterative solver did not converge
     };
 
     /**
@@ -148,6 +205,30 @@ namespace lad{
         FILTER_DISTANCE = 2, //!< Computes the normal distance between a point cloud and its fitting plane
         FILTER_GEOTECH  = 3, //!< Computes the normal distance between a pointclod and the true-landing plane within a circular window
         FILTER_CONVEX_SLOPE  = 4, //!< Computes the slope from the triangle intersecting the terrain convex-hull and the vertical projection of the vehicle CoG
+        FILTER_RESIDUAL = 5, //!< Computes the RMS of the normal distance between the points in the sliding window and their fitting plane
+        FILTER_PLANE    = 6, //!< Stores the coefficients (a, b, c, d) of the fitting plane and the number of points of the sliding window (PLANE_LAYER_BANDS)
+        FILTER_TRI      = 7, //!< Terrain Ruggedness Index: mean absolute elevation difference between the window center and the other points of the window
+        FILTER_TPI      = 8, //!< Topographic Position Index: elevation of the window center minus the mean elevation of the other points of the window
+        FILTER_ROUGHNESS= 9, //!< Roughness: elevation range (max - min) of the points in the sliding window
+        FILTER_CURVATURE=10, //!< Curvature [1/m]: laplacian 2.(q0 + q1) of the least-squares quadric surface z = q0.x^2 + q1.y^2 + q2.xy + q3.x + q4.y + q5 of the window. Positive for concave terrain
+    };
+
+    /**
+     * @brief List of available evaluation engines for applyWindowFilter()
+     * 
+     */
+    enum WindowEngine{
+        ENGINE_GATHER   = 0, //!< Gathers the points of every window and fits them with CGAL (reference implementation)
+        ENGINE_MOMENTS  = 1, //!< Evaluates FILTER_MEAN and FILTER_SLOPE from row prefix sums of the raster moments
+    };
+
+    /**
+     * @brief List of available solvers for the convex hull plane of FILTER_CONVEX_SLOPE
+     * 
+     */
+    enum HullSolver{
+        HULL_ENVELOPE   = 0, //!< Upper envelope (dual simplex) solver, finds only the facet above the window center
+        HULL_CGAL       = 1, //!< Complete 3D convex hull (CGAL convex_hull_3) and facet scan (reference implementation)
     };
 };
 
@@ -15,6 +15,7 @@
 
 #include "headers.h"
 #include "lad_enum.hpp"
+#include "lad_window.hpp"
 
 using namespace std; // STL
 using namespace cv;  // OpenCV
@@ -127,29 +128,45 @@ namespace lad
     private:
         double rasterStats[4];
         // double dfNoData; -> promoted to pipeline level, no longer defined per raster
+        cv::Mat rasterMask; //Valid data mask (0=invalid, 255=valid), derived on demand or shared with the layer it was copied from
+        bool maskDerived;   //The mask is derived from rasterData (see updateMask) rather than set explicitly
+        double maskNoData;  //NO-DATA value the derived mask compares rasterData against
 
     public:
         // this should interface with OpenCV Mat and 2D matrix (vector style)
         // \todo check if size/type must/can be updated at construction time
         cv::Mat rasterData; //OpenCV matrix that will hold the data
-        cv::Mat rasterMask; //OpenCV matrix with valida data mask (0=invalid, 255=valid)
+        double quantScale;  //Elevation step of the quantised rasterData (value = quantOffset + quantScale * q), zero if the layer is not quantised
+        double quantOffset; //Elevation of the quantised value zero
+        int quantType;      //Integer type of the exported quantised samples (CV_16SC1 or CV_32SC1)
 
         RasterLayer(std::string name, int id) : Layer(name, id)
         {
             setType(LAYER_RASTER); 
+            quantScale = 0;
+            quantOffset = 0;
+            quantType = CV_32SC1;
+            maskDerived = false;
+            maskNoData = 0;
         }
 
         RasterLayer operator+(const RasterLayer& b);
         int loadData(cv::Mat *);
-        int readTIFF(std::string name); // read and load raster data from a geoTIFF file
+        int readTIFF(std::string name, double quantStep = 0); // read and load raster data from a geoTIFF file, optionally quantised to quantStep
+        int quantize(double step);                            // Snap rasterData to integer multiples of step, see quantScale
+        bool isQuantized() { return quantScale > 0; }
         int writeLayer(std::string outputFilename, int fileFormat, int outputCoordinate); // Overloaded method of exporting vectorData to user defined file
         void showInformation();
         double getDiagonalSize();
+        int setHalo(int size); // Reallocate rasterData as the center of a padded buffer with a NODATA halo of <size> px
+        int getHalo();         // Width of the NODATA halo around rasterData, zero if none
 
         void copyGeoProperties(shared_ptr<RasterLayer> src); //!< Copy geoTIFF specific properties from a source layer
         void updateStats(); //!< Recomputes stats of valid raster data
         void updateMask();          //!< Update valid data mask by comparing rasterData with implicit no-data value 
         void updateMask(double nd); //!< Update valid data mask by comparing rasterData with user-provided no-data value
+        cv::Mat getMask();                 //!< Valid data mask (8UC1), derived from rasterData on first use after updateMask
+        void setMask(const cv::Mat &mask); //!< Share an explicit valid data mask, e.g. the mask of a source layer (see copyMask)
         double getMin()     {return rasterStats[LAYER_MIN];}    // we assume the values are up-to-date      
         double getMax()     {return rasterStats[LAYER_MAX];}    //\todo force update after modiciations
         double getMean()    {return rasterStats[LAYER_MEAN];}    // easy to enforce when loading raster data from file
@@ -196,6 +213,7 @@ namespace lad
 
     public:
         cv::Mat rotatedData; //OpenCV matrix that will hold the data
+        KernelBank bank;     //Sparse (span based) versions of rotatedData, updated every time the rotation changes
 
         void showInformation(); // redefinition of the method for KernelLayer class
         void setRotation(double); //set-get pair for dRotation parameter
@@ -41,10 +41,15 @@ namespace lad
 
     double computePlaneSlope(KPlane plane, KVector reference = KVector(0,0,-1));
 
-    std::vector<double> computePlaneDistance(KPlane plane, std::vector<KPoint> points);
+    std::vector<double> computePlaneDistance(KPlane plane, const std::vector<KPoint> &points);
+    int computePlaneDistance(KPlane plane, const std::vector<KPoint> &points, std::vector<double> &distances); // allocation-free version, reuses <distances>
 
-    KPlane computeConvexHullPlane (const std::vector<KPoint> &points); 
-    KPlane computeFittingPlane (std::vector<KPoint> points);
+    KPlane computeConvexHullPlane (const std::vector<KPoint> &points, int solver = HULL_CGAL); 
+    KPlane computeConvexHullPlaneCGAL (const std::vector<KPoint> &points, double qx = 0.0001, double qy = 0.0001); // reference implementation, full 3D convex hull + facet scan
+    KPlane computeConvexHullPlaneAABB (const std::vector<KPoint> &points, double qx = 0.0001, double qy = 0.0001); // former reference: per call hull mesh + AABB ray query (hull_bench baseline)
+    int computeUpperEnvelopePlane (const std::vector<KPoint> &points, KPlane &plane, double qx = 0.0001, double qy = 0.0001); // facet of the upper hull above (qx, qy)
+    KPlane computeFittingPlane (const std::vector<KPoint> &points);
+    int computeFittingQuadric (const std::vector<KPoint> &points, double *q); // least-squares quadric surface z = f(x, y), 6 coefficients
     int computePointsInSensor  (const std::vector<KPoint> &inpoints, std::vector<KPoint> &outpoints, double diameter);
 
     // std::vector<pcl::PointXYZ> convertMatrix2Vector2 (cv::Mat *matrix, double sx, double sy, double *acum);
@@ -0,0 +1,66 @@
+/**
+ * @file lad_simd.hpp
+ * @author Jose Cappelletto (cappelletto@gmail.com)
+ * @brief Runtime (CPUID) dispatch of the SIMD kernels of the Landing Area Detection (lad) algorithm
+ * @version 0.1
+ * @date 2024-03-18
+ * @details The kernels are compiled once per instruction set, each in its own translation unit with the matching
+ * compiler flags (lad_simd_sse42.cpp, lad_simd_avx2.cpp, lad_simd_avx512.cpp), so the rest of the project is built
+ * for the baseline architecture and the same binary runs on any x86-64 CPU. This header is included by those
+ * translation units, so it must not pull any other project (or third party) header
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef _LAD_SIMD_HPP_
+#define _LAD_SIMD_HPP_
+
+namespace lad
+{
+    /**
+     * @brief Instruction sets of the SIMD kernels
+     *
+     */
+    enum SimdIsa
+    {
+        ISA_AUTO = -1,  //!< Best instruction set supported by the CPU
+        ISA_SCALAR = 0, //!< Portable kernels, built with the baseline compiler flags
+        ISA_SSE42 = 1,  //!< SSE4.2, 2 lanes of double precision
+        ISA_AVX2 = 2,   //!< AVX2, 4 lanes of double precision
+        ISA_AVX512 = 3  //!< AVX-512F, 8 lanes of double precision
+    };
+
+    /**
+     * @brief Table of the kernels compiled for a given instruction set
+     *
+     */
+    typedef struct simdKernels_
+    {
+        int isa;   //!< Instruction set of the kernels (SimdIsa)
+        int width; //!< Number of double precision lanes
+
+        //! Vertical component |v_z| of the smallest eigenvector of a batch of symmetric 3x3 matrices, stored as structure of
+        //! arrays [a00 a01 a02 a11 a12 a22]. Only complete groups of <width> matrices are solved: returns how many were
+        int (*computeVerticalComponents)(const double *const *a, int count, double *nz);
+
+        //! Sum of the measurability scores of the valid sensor points (see computeSensorScore), read through linear offsets
+        //! from the anchor sample. The number of valid points is returned in n
+        double (*computeSensorScore64)(const double *anchor, const long *offset, const double *x, const double *y, int total, const double *plane,
+                                       double nodata, double zOptimal, double zSuboptimal, int *n);
+        double (*computeSensorScore32)(const float *anchor, const long *offset, const double *x, const double *y, int total, const double *plane,
+                                       double nodata, double zOptimal, double zSuboptimal, int *n);
+    } SimdKernels;
+
+    const SimdKernels *getSimdKernelsSSE42();  // SSE4.2 kernels, nullptr if the compiler could not build them
+    const SimdKernels *getSimdKernelsAVX2();   // AVX2 kernels, nullptr if the compiler could not build them
+    const SimdKernels *getSimdKernelsAVX512(); // AVX-512F kernels, nullptr if the compiler could not build them
+
+    int detectSimdIsa();                   // Best instruction set supported by both the CPU and the build
+    int setSimdIsa(int isa);               // Select the kernels of an instruction set (ISA_AUTO to detect it), returns the selected one
+    const SimdKernels &getSimdKernels();   // Kernels currently selected, detected on first use
+    const char *getSimdIsaName(int isa);   // Printable name of an instruction set
+    int parseSimdIsa(const char *name);    // Instruction set from its name (AUTO | SCALAR | SSE42 | AVX2 | AVX512), -2 if unknown
+}
+
+#endif // _LAD_SIMD_HPP_
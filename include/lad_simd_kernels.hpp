@@ -0,0 +1,139 @@
+/**
+ * @file lad_simd_kernels.hpp
+ * @author Jose Cappelletto (cappelletto@gmail.com)
+ * @brief Instruction set independent bodies of the SIMD kernels, see lad_simd.hpp
+ * @version 0.1
+ * @date 2024-03-18
+ * @details Included by the per instruction set translation units only, after the definition of their lane wrapper.
+ * Every function has internal linkage, so the copies built with different compiler flags never collide at link time
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef _LAD_SIMD_KERNELS_HPP_
+#define _LAD_SIMD_KERNELS_HPP_
+
+#include "lad_simd.hpp"
+
+#include <math.h>
+
+namespace lad
+{
+    namespace
+    {
+        /**
+         * @brief SIMD version of computeSmallestEigenvector, restricted to the vertical component of the eigenvector. It
+         * evaluates V::W symmetric matrices stored as structure of arrays. Only the roots of the characteristic cubic
+         * (acos/cos) are computed per lane, everything else runs in vector registers
+         *
+         * @param a Pointers to the six upper triangular components [a00 a01 a02 a11 a12 a22] of the first matrix
+         * @param nz Output |v_z| of the smallest eigenvector of each matrix, 1 for degenerate matrices
+         */
+        template <class V>
+        inline void computeLaneVerticalComponent(const double *const *a, double *nz)
+        {
+            typedef typename V::T T;
+            typedef typename V::M M;
+            const T one = V::set1(1.0);
+            const T tiny = V::set1(1e-300);
+            T a00 = V::load(a[0]), a01 = V::load(a[1]), a02 = V::load(a[2]);
+            T a11 = V::load(a[3]), a12 = V::load(a[4]), a22 = V::load(a[5]);
+
+            T q = V::mul(V::add(V::add(a00, a11), a22), V::set1(1.0 / 3.0));
+            T b00 = V::sub(a00, q), b11 = V::sub(a11, q), b22 = V::sub(a22, q);
+            T p1 = V::add(V::add(V::mul(a01, a01), V::mul(a02, a02)), V::mul(a12, a12));
+            T p2 = V::add(V::add(V::add(V::mul(b00, b00), V::mul(b11, b11)), V::mul(b22, b22)), V::add(p1, p1));
+            T p = V::sqrt(V::mul(p2, V::set1(1.0 / 6.0)));
+            M flat = V::le(p, tiny); // A = q.I
+            T ps = V::select(flat, p, one);
+            T det = V::sub(V::add(V::mul(b00, V::sub(V::mul(b11, b22), V::mul(a12, a12))),
+                                  V::mul(a02, V::sub(V::mul(a01, a12), V::mul(b11, a02)))),
+                           V::mul(a01, V::sub(V::mul(a01, b22), V::mul(a12, a02))));
+            T r = V::div(V::mul(det, V::set1(0.5)), V::mul(V::mul(ps, ps), ps));
+            r = V::min(one, V::max(V::set1(-1.0), r));
+
+            // smallest root of the characteristic cubic, per lane
+            double rl[V::W], pl[V::W], ql[V::W], ll[V::W];
+            V::store(rl, r);
+            V::store(pl, p);
+            V::store(ql, q);
+            for (int i = 0; i < V::W; i++)
+                ll[i] = ql[i] + 2.0 * pl[i] * cos(acos(rl[i]) / 3.0 + (2.0 * M_PI / 3.0));
+            T lambda = V::load(ll);
+
+            // rows of (A - lambda.I) and their cross products
+            T r00 = V::sub(a00, lambda), r11 = V::sub(a11, lambda), r22 = V::sub(a22, lambda);
+            // r0 = [r00 a01 a02], r1 = [a01 r11 a12], r2 = [a02 a12 r22]
+            T c0x = V::sub(V::mul(a01, a12), V::mul(a02, r11));
+            T c0y = V::sub(V::mul(a02, a01), V::mul(r00, a12));
+            T c0z = V::sub(V::mul(r00, r11), V::mul(a01, a01));
+            T c1x = V::sub(V::mul(a01, r22), V::mul(a02, a12));
+            T c1y = V::sub(V::mul(a02, a02), V::mul(r00, r22));
+            T c1z = V::sub(V::mul(r00, a12), V::mul(a01, a02));
+            T c2x = V::sub(V::mul(r11, r22), V::mul(a12, a12));
+            T c2y = V::sub(V::mul(a12, a02), V::mul(a01, r22));
+            T c2z = V::sub(V::mul(a01, a12), V::mul(r11, a02));
+            T n0 = V::add(V::add(V::mul(c0x, c0x), V::mul(c0y, c0y)), V::mul(c0z, c0z));
+            T n1 = V::add(V::add(V::mul(c1x, c1x), V::mul(c1y, c1y)), V::mul(c1z, c1z));
+            T n2 = V::add(V::add(V::mul(c2x, c2x), V::mul(c2y, c2y)), V::mul(c2z, c2z));
+
+            // keep the largest cross product, same preference order as the scalar solver
+            M m1 = V::gt(n1, n0);
+            T bz = V::select(m1, c0z, c1z);
+            T bn = V::select(m1, n0, n1);
+            M m2 = V::gt(n2, bn);
+            bz = V::select(m2, bz, c2z);
+            bn = V::select(m2, bn, n2);
+
+            M degenerate = V::lor(flat, V::le(bn, tiny));
+            T vz = V::div(V::abs(bz), V::sqrt(V::select(degenerate, bn, one)));
+            V::store(nz, V::select(degenerate, vz, one));
+        }
+
+        /**
+         * @brief Solve every complete group of V::W matrices of a structure of arrays, see computeLaneVerticalComponent
+         *
+         * @return int Number of solved matrices, the remaining (count % V::W) are left to the caller
+         */
+        template <class V>
+        int computeVerticalComponents(const double *const *a, int count, double *nz)
+        {
+            int i = 0;
+            for (; i + V::W <= count; i += V::W)
+            {
+                const double *lane[6] = {a[0] + i, a[1] + i, a[2] + i, a[3] + i, a[4] + i, a[5] + i};
+                computeLaneVerticalComponent<V>(lane, nz + i);
+            }
+            return i;
+        }
+
+        /**
+         * @brief Residual scoring loop of computeSensorScore. It is branch free, so the compiler vectorizes it (with
+         * gathers where the instruction set has them) for the flags of the including translation unit. The validity test
+         * covers both NODATA representations: NaN fails (z == z), and a sentinel fails (z != nodata)
+         */
+        template <class R>
+        double computeSensorScoreKernel(const R *anchor, const long *offset, const double *x, const double *y, int total, const double *plane,
+                                        double nodata, double zOptimal, double zSuboptimal, int *n)
+        {
+            double a = plane[0], b = plane[1], c = plane[2], d = plane[3];
+            double score = 0;
+            int valid = 0;
+#pragma omp simd reduction(+ : score, valid)
+            for (int k = 0; k < total; k++)
+            {
+                double z = anchor[offset[k]];
+                bool ok = (z == z) & (z != nodata) & (z != 0.0);
+                double dist = fabs(a * x[k] + b * y[k] + c * z + d);
+                double s = (dist < zOptimal) ? 1.0 : 1 / (1 + (dist - zOptimal) / zSuboptimal);
+                score += ok ? s : 0.0;
+                valid += ok;
+            }
+            *n = valid;
+            return score;
+        }
+    }
+}
+
+#endif // _LAD_SIMD_KERNELS_HPP_
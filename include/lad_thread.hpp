@@ -69,6 +69,15 @@ namespace lad{
      */
     int processLaneX(lad::Pipeline *ap, parameterStruct *param, std::string suffix = "");
 
+    /**
+     * @brief Computes lanes (C) and (X) for the least-square slope algorithm, from a single fused window pass
+     * 
+     * @param ap Pointer to Pipeline object containing a valid stack for processing
+     * @param param Pointer to structure containing all the parameters (slope, geotech params and LAUV footprint)
+     * @return int error code, if any
+     */
+    int processLaneCX(lad::Pipeline *ap, parameterStruct *param, std::string suffix = "");
+
     /**
      * @brief Dispatcher for rotation-specific group of workers while multithreading using dispatcher-worker model
      * 
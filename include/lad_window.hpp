@@ -0,0 +1,565 @@
+/**
+ * @file lad_window.hpp
+ * @author Jose Cappelletto (cappelletto@gmail.com)
+ * @brief Sliding window engine of the Landing Area Detection (lad) algorithm. Provides row prefix-sum tables of the
+ *        raster moments, sparse description of the kernel footprints and closed-form plane fitting
+ * @version 0.1
+ * @date 2024-03-18
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+// pragma once is not "standard"
+#ifndef _LAD_WINDOW_HPP_
+#define _LAD_WINDOW_HPP_
+
+#include "headers.h"
+#include "lad_enum.hpp"
+
+#include <climits>
+#include <cstdint>
+#include <cfloat>
+
+namespace lad
+{ // landing area detection algorithm namespace
+
+    /**
+     * @brief Raw first and second order moments of a 3D point cloud. They are enough to recover the least-squares
+     * (orthogonal) fitting plane of the cloud, without revisiting the points
+     *
+     */
+    typedef struct planeMoments_
+    {
+        double n;                      // number of points
+        double x, y, z;                // first order sums
+        double xx, yy, zz, xy, xz, yz; // second order sums
+    } PlaneMoments;
+
+    /**
+     * @brief Running (prefix) sums of the moments of a single raster row. Column index 'c' is used as horizontal coordinate,
+     * and 'z' is the elevation relative to the reference value of the table
+     *
+     */
+    typedef struct rowMoments_
+    {
+        double n;  // number of valid samples
+        double c;  // sum(c)
+        double cc; // sum(c*c)
+        double z;  // sum(z)
+        double cz; // sum(c*z)
+        double zz; // sum(z*z)
+    } RowMoments;
+
+    /**
+     * @brief Integer version of RowMoments, for rasters stored as quantised elevation (see RasterLayer::quantize). Every
+     * sum is exact, so the differences of the prefix sums do not suffer any cancellation
+     *
+     */
+    typedef struct rowMomentsQ_
+    {
+        int64_t n;  // number of valid samples
+        int64_t c;  // sum(c)
+        int64_t cc; // sum(c*c)
+        int64_t z;  // sum(q)
+        int64_t cz; // sum(c*q)
+        int64_t zz; // sum(q*q)
+    } RowMomentsQ;
+
+    /**
+     * @brief Horizontal run of active kernel pixels, relative to the kernel anchor. It covers the columns [x0, x1) of row dy
+     *
+     */
+    typedef struct kernelSpan_
+    {
+        int dy;     // row offset from the anchor
+        int x0;     // first column offset (inclusive)
+        int x1;     // last column offset (exclusive)
+        int offset; // linear offset of (dy, x0) from the anchor, for the current stride of the footprint
+    } KernelSpan;
+
+    /**
+     * @brief Sparse description of a (rotated) kernel as a list of horizontal runs of active pixels
+     *
+     */
+    class KernelFootprint
+    {
+    public:
+        std::vector<KernelSpan> spans; //!< Row spans of active pixels, sorted by row
+        int anchorRow;                 //!< Anchor (center) row of the kernel, in kernel pixel coordinates
+        int anchorCol;                 //!< Anchor (center) column of the kernel, in kernel pixel coordinates
+        int nPixels;                   //!< Total number of active pixels
+        int stride;                    //!< Row stride (in elements) used to compute the linear offsets of the spans
+        int margin;                    //!< Readable NODATA halo [px] around the raster of the current stride, see getRasterHalo
+        cv::Rect bbox;                 //!< Bounding box of the active pixels, relative to the anchor
+
+        KernelFootprint()
+        {
+            anchorRow = 0;
+            anchorCol = 0;
+            nPixels = 0;
+            stride = 0;
+            margin = 0;
+        }
+
+        int build(const cv::Mat &kernel, int anchorRow, int anchorCol); // Extract the row spans from a binary (8UC1) kernel
+        void setStride(int stride, int margin = 0);                     // Update the linear offsets of the spans for a given row stride (and halo)
+        int subsample(int budget, KernelFootprint &dst) const;          // Stratified grid subsample with at most ~budget pixels
+
+        /**
+         * @brief Check if the footprint anchored at (row, col) can be read without clipping: it lies completely inside the
+         * [0, rowLimit) x [0, colLimit) area, extended by the halo margin of the raster
+         */
+        bool isInside(int row, int col, int rowLimit, int colLimit) const
+        {
+            return (row + bbox.y >= -margin) && (row + bbox.y + bbox.height <= rowLimit + margin) &&
+                   (col + bbox.x >= -margin) && (col + bbox.x + bbox.width <= colLimit + margin);
+        }
+    };
+
+    /**
+     * @brief Precomputed sparse representations of a single (rotated) kernel. It is rebuilt by KernelLayer every time its
+     * rotation changes, so it is computed once per heading and shared by every consumer of that kernel
+     *
+     */
+    class KernelBank
+    {
+    public:
+        KernelFootprint window; //!< Footprint clipped to the sliding window of applyWindowFilter, anchored at (h/2, w/2)
+        KernelFootprint shape;  //!< Complete footprint anchored as cv::erode/cv::dilate default anchor, for morphology ops
+
+        int build(const cv::Mat &kernel); // Rebuild both footprints from a dense kernel (any type, non-zero is active)
+    };
+
+    /**
+     * @brief Row prefix-sum table of the raster moments. Any horizontal run of a row can be reduced to its moments in O(1),
+     * so the moments of a sliding window cost O(kernel height) rather than O(kernel area).
+     * @details The elevation is stored relative to the mean of the valid data (zRef) to reduce the cancellation of the
+     * second order sums. For rasters up to ~10k columns and elevation ranges of a few tens of meters the slopes recovered
+     * from the table agree with the point-cloud fit of the gathering engine within 1e-6 degrees (see window_check). Wider
+     * rasters or larger ranges degrade gracefully, as the error grows with the magnitude of the prefix sums. Quantised
+     * rasters (buildQuantized) keep integer prefix sums instead, which are exact for any raster size
+     */
+    class MomentTable
+    {
+    public:
+        int rows;                    //!< Number of rows of the source raster
+        int cols;                    //!< Number of columns of the source raster
+        double zRef;                 //!< Reference elevation substracted from every sample
+        double zScale;               //!< Elevation step [m] of the integer table, zero for the floating point table
+        std::vector<RowMoments> data; //!< rows x (cols + 1) prefix sums, first element of every row is zero
+        std::vector<RowMomentsQ> qdata; //!< rows x (cols + 1) integer prefix sums of the quantised table, empty otherwise
+
+        MomentTable()
+        {
+            rows = 0;
+            cols = 0;
+            zRef = 0;
+            zScale = 0;
+        }
+
+        int build(const cv::Mat &raster, double nodata); // Populate the table from a RASTER_TYPE raster
+        int buildQuantized(const cv::Mat &raster, double nodata, double scale, double offset); // Exact integer table from a quantised raster
+        void accumulate(int row, int col, const KernelFootprint &footprint, int rowLimit, int colLimit, PlaneMoments &m) const; // Moments of the footprint anchored at (row, col)
+
+    private:
+        void accumulateQuantized(int row, int col, const KernelFootprint &footprint, int rowLimit, int colLimit, PlaneMoments &m) const;
+    };
+
+    /**
+     * @brief Pixels covered by the circular footprint of the geotechnical sensor, centered at the window anchor, stored as
+     * structure of arrays. The circle does not depend on the vehicle heading, so it is built once per raster and shared by
+     * every heading: scoring a window only needs its plane and a residual loop over these offsets
+     *
+     */
+    class SensorFootprint
+    {
+    public:
+        std::vector<int> dy;      //!< Row offset of every pixel, relative to the anchor
+        std::vector<int> dx;      //!< Column offset of every pixel, relative to the anchor
+        std::vector<double> x;    //!< Horizontal coordinate [m] of every pixel, relative to the anchor
+        std::vector<double> y;    //!< Vertical coordinate [m] of every pixel, relative to the anchor
+        std::vector<long> offset; //!< Linear offset of every pixel from the anchor, for the stride of the raster
+        int reach;                //!< Largest row or column offset (absolute value) of the footprint
+        int stride;               //!< Row stride (in elements) of the raster used to compute the linear offsets
+        int margin;               //!< Readable NODATA halo [px] around the raster, see getRasterHalo
+
+        SensorFootprint()
+        {
+            reach = 0;
+            stride = 0;
+            margin = 0;
+        }
+
+        int build(double diameter, double sx, double sy, const cv::Mat &raster); // Pixels of the sensor circle, with the stride and halo of the raster
+        bool isCoveredBy(const KernelFootprint &footprint) const;               // Check that every pixel of the sensor lies inside a kernel footprint
+
+        /**
+         * @brief Check if the sensor anchored at (row, col) can be read without clipping, see KernelFootprint::isInside
+         */
+        bool isInside(int row, int col, int rowLimit, int colLimit) const
+        {
+            return (row - reach >= -margin) && (row + reach < rowLimit + margin) && (col - reach >= -margin) && (col + reach < colLimit + margin);
+        }
+    };
+
+    /**
+     * @brief Per-thread reusable buffers for the point gathering path of the window filters. Buffers only grow, so once
+     * they reach the size of the kernel the sliding window loop runs without heap allocations
+     *
+     */
+    class WindowScratch
+    {
+    public:
+        std::vector<KPoint> points;    //!< Points of the current window (masked by kernel and valid data)
+        std::vector<KPoint> sensor;    //!< Subset of points that fall inside the geotech sensor footprint
+        std::vector<double> distances; //!< Point to plane distances
+        double center;                 //!< Elevation of the window anchor (center) pixel
+        int row, col;                  //!< Raster position of the window anchor
+
+        /**
+         * @brief Empty the buffers, keeping their capacity. Capacity is extended to hold at least nPixels points
+         *
+         * @param nPixels expected maximum number of points of the window (kernel area)
+         */
+        void reset(size_t nPixels)
+        {
+            points.clear();
+            sensor.clear();
+            distances.clear();
+            if (points.capacity() < nPixels)
+            {
+                points.reserve(nPixels);
+                sensor.reserve(nPixels);
+                distances.reserve(nPixels);
+            }
+        }
+    };
+
+    /**
+     * @brief Upper chain of the valid samples of a raster column, in the (row, Z) plane, for the rows covered by a window.
+     * Samples below the chain lie below a segment of the same column, so they can never be a vertex of the upper hull of
+     * any window that contains the whole run
+     *
+     */
+    typedef struct hullColumn_
+    {
+        std::vector<int> runs;  // clipped [r0, r1) row runs covered by the window, used as cache key
+        std::vector<int> left;  // clipped row runs of the left neighbour column (only with candidate pruning)
+        std::vector<int> right; // clipped row runs of the right neighbour column (only with candidate pruning)
+        std::vector<int> row;   // raster row of every chain vertex
+        std::vector<double> z;  // elevation of every chain vertex
+        int n;                  // number of valid samples in the runs
+        double sum;             // sum of the elevation of the valid samples
+        bool valid;             // the entry holds the chain of the current raster row
+    } HullColumn;
+
+    /**
+     * @brief Sliding window candidate set for the convex hull slope filter. When the window moves one column along a row,
+     * the column chains still covered with the same row runs are reused; only the entering column (and any column whose
+     * runs changed, e.g. rotated kernels) is rebuilt. The candidate set is the union of the chains, which has exactly the
+     * same upper hull as the complete window
+     *
+     */
+    class HullSweep
+    {
+    public:
+        std::vector<std::vector<int>> columnRuns; //!< [dy0, dy1) runs of active rows for every kernel column
+        int dx0;                                  //!< Column offset (relative to the anchor) of the first kernel column
+        int row;                                  //!< Raster row of the cached columns, -1 if none
+        std::vector<HullColumn> cache;            //!< One entry per raster column
+        cv::Mat candidates;                       //!< Optional upper hull candidate bitmap (8UC1), empty to keep every sample
+        std::vector<int> runs;                    //!< Scratch runs of the column being gathered
+        std::vector<int> runsLeft;                //!< Scratch runs of its left neighbour column
+        std::vector<int> runsRight;               //!< Scratch runs of its right neighbour column
+
+        HullSweep()
+        {
+            dx0 = 0;
+            row = -1;
+        }
+
+        int setup(const KernelFootprint &footprint, int nCols, const cv::Mat &upperCandidates = cv::Mat()); // Transpose the footprint spans into column runs, and size the cache
+        void reset(int row);                                     // Invalidate the cache when moving to a new raster row
+        int clipRuns(int k, int row, int col, int rowLimit, int colLimit, std::vector<int> &out) const; // Clipped row runs of kernel column k
+        int gather(const cv::Mat &raster, double nodata, int row, int col, int rowLimit, int colLimit, int cRow, int cCol,
+                   double sx, double sy, std::vector<KPoint> &points, double *acum); // Candidate points of the window anchored at (row, col)
+    };
+
+    /**
+     * @brief Base filter policy of the gathering window engine (computeWindowFilter). A policy provides the three hooks of
+     * the per-pixel pipeline: gather the points of the window, reduce them to the output value, and emit it. The engine
+     * is instantiated once per policy, so every filter runs as its own specialised loop. Derived policies provide reduce()
+     * and may hide the default gather()/emit() hooks
+     *
+     */
+    class WindowPolicy
+    {
+    public:
+        double diameter; //!< Diameter of the sensor footprint, whose points are also gathered apart. Zero to disable
+
+        WindowPolicy()
+        {
+            diameter = 0;
+        }
+
+        int gather(const cv::Mat &raster, double nodata, int row, int col, const KernelFootprint &footprint, int rowLimit, int colLimit,
+                   int cRow, int cCol, double sx, double sy, WindowScratch &scratch, double *acum) const; // Points of the window (and sensor footprint)
+
+        /**
+         * @brief Store the reduced value of the window anchored at column col
+         */
+        void emit(raster_t *dst, int col, double value) const
+        {
+            dst[col] = value;
+        }
+    };
+
+    /**
+     * @brief FILTER_MEAN policy: mean elevation of the window
+     */
+    class MeanPolicy : public WindowPolicy
+    {
+    public:
+        bool reduce(WindowScratch &scratch, double acum, int nSensor, double &value) const;
+    };
+
+    /**
+     * @brief FILTER_SLOPE policy: slope of the least-square fitting plane of the window
+     */
+    class SlopePolicy : public WindowPolicy
+    {
+    public:
+        bool reduce(WindowScratch &scratch, double acum, int nSensor, double &value) const;
+    };
+
+    /**
+     * @brief FILTER_CONVEX_SLOPE policy: slope of the convex hull facet above the center of the window
+     */
+    class ConvexSlopePolicy : public WindowPolicy
+    {
+    public:
+        int solver; //!< Convex hull plane solver (HullSolver)
+
+        ConvexSlopePolicy(int hullSolver = HULL_CGAL)
+        {
+            solver = hullSolver;
+        }
+
+        bool reduce(WindowScratch &scratch, double acum, int nSensor, double &value) const;
+    };
+
+    /**
+     * @brief FILTER_DISTANCE policy: mean measurability score of every point of the window to its fitting plane
+     */
+    class DistancePolicy : public WindowPolicy
+    {
+    public:
+        double zOptimal;    //!< Optimal range along the sensing axis
+        double zSuboptimal; //!< Suboptimal range along the sensing axis
+
+        DistancePolicy(double z_optimal, double z_suboptimal)
+        {
+            zOptimal = z_optimal;
+            zSuboptimal = z_suboptimal;
+        }
+
+        bool reduce(WindowScratch &scratch, double acum, int nSensor, double &value) const;
+    };
+
+    /**
+     * @brief FILTER_GEOTECH policy: mean measurability score of the points inside the sensor footprint to the fitting plane
+     * of the whole window. With a sensor footprint, the sensor points are read from the raster at full resolution
+     * (computeSensorScore) rather than gathered with the window points, which may be subsampled
+     */
+    class GeotechPolicy : public DistancePolicy
+    {
+    public:
+        const SensorFootprint *sensor; //!< Shared sensor footprint of the raster, nullptr to gather the sensor points
+        const cv::Mat *raster;         //!< Source raster read through the sensor footprint
+        double nodata;                 //!< No-data value of the raster
+
+        GeotechPolicy(double sensorDiameter, double z_optimal, double z_suboptimal, const SensorFootprint *sensorFootprint = nullptr,
+                      const cv::Mat *src = nullptr, double srcNoData = 0) : DistancePolicy(z_optimal, z_suboptimal)
+        {
+            sensor = (sensorFootprint != nullptr && src != nullptr) ? sensorFootprint : nullptr;
+            raster = src;
+            nodata = srcNoData;
+            diameter = sensor ? 0 : sensorDiameter;
+        }
+
+        bool reduce(WindowScratch &scratch, double acum, int nSensor, double &value) const;
+    };
+
+    /**
+     * @brief FILTER_TRI policy: mean absolute elevation difference between the window center and its neighbours
+     */
+    class TriPolicy : public WindowPolicy
+    {
+    public:
+        bool reduce(WindowScratch &scratch, double acum, int nSensor, double &value) const;
+    };
+
+    /**
+     * @brief FILTER_TPI policy: elevation of the window center minus the mean elevation of its neighbours
+     */
+    class TpiPolicy : public WindowPolicy
+    {
+    public:
+        bool reduce(WindowScratch &scratch, double acum, int nSensor, double &value) const;
+    };
+
+    /**
+     * @brief FILTER_ROUGHNESS policy: elevation range of the window
+     */
+    class RoughnessPolicy : public WindowPolicy
+    {
+    public:
+        bool reduce(WindowScratch &scratch, double acum, int nSensor, double &value) const;
+    };
+
+    /**
+     * @brief FILTER_CURVATURE policy: laplacian of the least-squares quadric surface z = q0.x^2 + q1.y^2 + q2.xy + q3.x +
+     * q4.y + q5 of the window (see computeFittingQuadric), d2z/dx2 + d2z/dy2 = 2.(q0 + q1)
+     */
+    class CurvaturePolicy : public WindowPolicy
+    {
+    public:
+        bool reduce(WindowScratch &scratch, double acum, int nSensor, double &value) const;
+    };
+
+    /**
+     * @brief Terrain descriptors of a window, evaluated in a single traversal of its points
+     *
+     * @param points Points of the window, relative to the window center
+     * @param center Elevation of the window center
+     * @param tri Output Terrain Ruggedness Index, center sample excluded (nullptr if not required)
+     * @param tpi Output Topographic Position Index, center sample excluded (nullptr if not required)
+     * @param roughness Output elevation range (nullptr if not required)
+     */
+    void computeTerrainDescriptors(const std::vector<KPoint> &points, double center, double *tri, double *tpi, double *roughness);
+
+    /**
+     * @brief Rectangular block of output pixels [row0, row1) x [col0, col1), scheduled as a single task by the tiled
+     * window filters. Tiles only partition the output: the halo of the windows anchored near the tile border is read
+     * straight from the shared (read-only) source raster
+     *
+     */
+    typedef struct windowTile_
+    {
+        int row0; //!< First row of the tile
+        int row1; //!< Row past the last row of the tile
+        int col0; //!< First column of the tile
+        int col1; //!< Column past the last column of the tile
+        double cost; //!< Estimated work of the tile (valid anchors x valid density of their windows), see ValidIndex::planTiles
+    } WindowTile;
+
+    int buildWindowTiles(int nRows, int nCols, int tileSize, std::vector<WindowTile> &tiles); // Split the output raster into square tiles
+
+    /**
+     * @brief Compact index of the valid (not NODATA) pixels of a raster, stored as the runs of valid columns of every row.
+     * Survey swaths are long and thin, so most of the bounding box of the raster is NODATA: the index is built once per
+     * raster and shared by every window filter and heading, to plan the tiles over the valid data only
+     *
+     */
+    class ValidIndex
+    {
+    public:
+        int rows;                  //!< Number of rows of the source raster
+        int cols;                  //!< Number of columns of the source raster
+        long nValid;               //!< Total number of valid pixels
+        cv::Mat mask;              //!< Valid data mask (8UC1, 255 for valid pixels)
+        std::vector<int> rowStart; //!< Index of the first run of every row, rows + 1 elements
+        std::vector<int> run0;     //!< First column of every run
+        std::vector<int> run1;     //!< Column past the last column of every run
+        std::vector<long> runSum;  //!< Number of valid pixels before every run (prefix sum), one more element than runs
+
+        ValidIndex()
+        {
+            rows = 0;
+            cols = 0;
+            nValid = 0;
+        }
+
+        int build(const cv::Mat &raster, double nodata);                 // Populate the index from a RASTER_TYPE raster
+        long countRow(int row, int col0, int col1) const;                 // Valid pixels of a row within [col0, col1)
+        long countRect(int row0, int row1, int col0, int col1) const;     // Valid pixels within a block, clipped to the raster
+        int planTiles(int tileSize, const cv::Rect &bbox, std::vector<WindowTile> &tiles) const; // Non-empty tiles, sorted by decreasing cost
+    };
+
+    /**
+     * @brief Run body(tile) for every tile. Tiles are generated as OpenMP tasks. Called from a thread of a running team
+     * (e.g. the heading loop of land.cpp, which runs the lanes of every heading on the thread of its iteration) they are
+     * executed by that team, where idle threads pick up the tiles of the headings still in progress. Outside any parallel
+     * region a new team is started: this includes plain std::threads, where omp_in_parallel() is false, so filters must
+     * not be run concurrently from several std::threads, or every one of them starts a full team
+     *
+     * @param tiles Tiles to be processed, see buildWindowTiles
+     * @param body Callable invoked as body(const WindowTile &). Tiles must write disjoint outputs
+     */
+    template <class Body>
+    void forEachWindowTile(const std::vector<WindowTile> &tiles, const Body &body)
+    {
+        int nTiles = tiles.size();
+        if (omp_in_parallel())
+        {
+#pragma omp taskloop grainsize(1) shared(tiles, body)
+            for (int t = 0; t < nTiles; t++)
+                body(tiles[t]);
+        }
+        else
+        {
+#pragma omp parallel
+#pragma omp single
+#pragma omp taskloop grainsize(1) shared(tiles, body)
+            for (int t = 0; t < nTiles; t++)
+                body(tiles[t]);
+        }
+    }
+
+    WindowScratch &getWindowScratch(); // Scratch buffers owned by the calling thread
+    int getRasterHalo(const cv::Mat &raster); // Width of the NODATA halo around a padded raster (RasterLayer::setHalo)
+    void computeValidMask(const cv::Mat &raster, double nodata, cv::Mat &mask); // 8UC1 mask (255) of the samples that are not NODATA, see isNoData
+    uint64_t hashBytes(const void *data, size_t size, uint64_t h = 0xcbf29ce484222325ULL); // FNV-1a hash of a block of bytes
+    uint64_t hashBytes(const cv::Mat &m, uint64_t h = 0xcbf29ce484222325ULL);              // FNV-1a hash of the samples, size and type of a matrix
+
+    int gatherFootprintPoints(const cv::Mat &raster, double nodata, int row, int col, const KernelFootprint &footprint, int rowLimit, int colLimit,
+                              int cRow, int cCol, double sx, double sy, std::vector<KPoint> &master, double *acum, std::vector<KPoint> &sensor, double diameter);
+    int erodeMask(const cv::Mat &src, const KernelFootprint &footprint, cv::Mat &dst);  // Binary erosion (8UC1) driven by the footprint spans
+    int dilateMask(const cv::Mat &src, const KernelFootprint &footprint, cv::Mat &dst); // Binary dilation (8UC1) driven by the footprint spans
+
+    int computeMomentNormal(const PlaneMoments &m, double sx, double sy, double *normal); // Closed-form least-squares plane normal from pixel space moments
+    double computeMomentSlope(const PlaneMoments &m, double sx, double sy);               // Slope [deg] of the least-squares plane from pixel space moments
+    double computeSmallestEigenvector(const double *A, double *v);                       // Smallest eigenpair of a symmetric 3x3 matrix (analytic)
+    int computeMomentSlopes(const PlaneMoments *m, int count, double sx, double sy, double *slope); // Batched (SIMD) slope [deg] for an array of moments
+
+    template <class Policy>
+    int computeWindowFilter(const cv::Mat &raster, double nodata, const KernelFootprint &footprint, double sx, double sy, const Policy &policy, cv::Mat &dst,
+                            int tileSize = DEFAULT_TILE_SIZE, const cv::Mat &pending = cv::Mat(),
+                            const ValidIndex *index = nullptr); // Gathering engine, instantiated for the filter policies
+    int computeMomentFilter(const cv::Mat &raster, double nodata, const MomentTable &table, const KernelFootprint &footprint, double sx, double sy,
+                            int filtertype, cv::Mat &dst, int tileSize = DEFAULT_TILE_SIZE, const ValidIndex *index = nullptr);
+    int computeMomentFilter(const cv::Mat &raster, double nodata, const MomentTable &table, const std::vector<KernelFootprint> &footprints, double sx,
+                            double sy, int filtertype, std::vector<cv::Mat> &dst, int tileSize = DEFAULT_TILE_SIZE,
+                            const ValidIndex *index = nullptr); // Heading-batched, one output raster per footprint
+    int computeConvexSweepFilter(const cv::Mat &raster, double nodata, const KernelFootprint &footprint, double sx, double sy, cv::Mat &dst,
+                                 const cv::Mat &upperCandidates = cv::Mat(), int hullSolver = HULL_CGAL, int tileSize = DEFAULT_TILE_SIZE,
+                                 const cv::Mat &pending = cv::Mat(), const ValidIndex *index = nullptr); // FILTER_CONVEX_SLOPE with sliding window candidate reuse
+    int computeSlopeScreen(const cv::Mat &raster, double nodata, const MomentTable &table, const KernelFootprint &footprint, double sx, double sy,
+                           int filtertype, double threshold, double margin, cv::Mat &dst, cv::Mat &pending, int tileSize = DEFAULT_TILE_SIZE,
+                           const ValidIndex *index = nullptr); // Convex slope bounds, pixels whose bound reaches the threshold are left pending
+    int computeHullCandidates(const cv::Mat &raster, double nodata, cv::Mat &upper, cv::Mat &lower); // Heading independent upper/lower hull candidate bitmaps
+    double computeSensorScore(const cv::Mat &raster, double nodata, int row, int col, const SensorFootprint &sensor, const double *plane,
+                              double zOptimal, double zSuboptimal); // Mean measurability of the sensor points against a plane (a, b, c, d), unit normal
+    int computeGeotechFilter(const cv::Mat &raster, double nodata, const MomentTable &table, const KernelFootprint &footprint, const SensorFootprint &sensor,
+                             double sx, double sy, double zOptimal, double zSuboptimal, cv::Mat &dst, int tileSize = DEFAULT_TILE_SIZE,
+                             const cv::Mat &pending = cv::Mat(), const ValidIndex *index = nullptr); // FILTER_GEOTECH from the window moments and the shared sensor footprint
+    double computeSubsampleDeviation(const cv::Mat &raster, double nodata, const KernelFootprint &full, const KernelFootprint &sampled, double sx, double sy,
+                                     int filtertype, double diameter, double zOptimal, double zSuboptimal, int nSamples,
+                                     double *meanDeviation = nullptr); // Max deviation of a plane-fit filter on a subsampled footprint against the full window
+    double computePrecisionDeviation(const cv::Mat &raster, double nodata, const KernelFootprint &footprint, double sx, double sy, const cv::Mat &slope,
+                                     int nSamples, double *meanDeviation = nullptr); // Max deviation [deg] of a slope map against the double precision fit
+
+} // namespace lad
+
+#endif // _LAD_WINDOW_HPP_
@@ -54,6 +54,18 @@ args::ValueFlag	<double> argGroundThreshold(argParser,"length", "Minimum height
 args::ValueFlag	<double> argValidThreshold(argParser,"ratio", "Minimum ratio of required valid pixels to generate PNG",{"valid_th"});
 
 args::ValueFlag	<std::string> 	argSlopeAlgorithm(argParser,"method", "Select terrain slope calculation algorithm: PLANE | CONVEX ", {"slope_algorithm"});
+args::ValueFlag	<std::string> 	argWindowEngine(argParser,"engine", "Select window filter evaluation engine: MOMENTS | GATHER ", {"window_engine"});
+args::ValueFlag	<std::string> 	argHullSolver(argParser,"solver", "Select convex hull plane solver: CGAL (default) | ENVELOPE ", {"hull_solver"});
+args::ValueFlag	<int>           argPointBudget(argParser,"points", "Max number of points gathered per window by the plane-fit filters (stratified grid subsample of the footprint). Zero to use every point", {"point_budget"});
+args::ValueFlag	<int>           argTileSize(argParser,"pixels", "Side [px] of the output tiles scheduled by the window filters. Zero to schedule complete rows", {"tile_size"});
+args::ValueFlag	<double>        argSlopeScreening(argParser,"degrees", "Guard band [deg] of the two-tier convex slope screening: hull slope only for windows whose bound reaches the slope threshold. Zero to disable", {"slope_screening"});
+args::ValueFlag	<double>        argQuantizationStep(argParser,"step", "Quantise the input bathymetry to this elevation step [m], with exact integer window moments and int16/int32 export. Zero to disable", {"quantization_step"});
+args::ValueFlag	<std::string>   argSimdIsa(argParser,"isa", "Force the instruction set of the SIMD kernels (benchmarking): AUTO | SCALAR | SSE42 | AVX2 | AVX512. Default: AUTO, detected at startup", {"isa"});
+args::Flag	         	        argAutotune(argParser, "", "Select the fastest window engine and tile size with a short calibration on the input (cached per kernel size, data density and machine)", {"autotune"});
+args::Flag	         	        argExclusionGating(argParser, "", "Skip the slope and measurability windows of pixels already excluded by missing data (C1)", {"exclusion_gating"});
+args::Flag	         	        argMeasurability(argParser, "", "Compute the measurability (X1) and final measurability (M4) maps of every heading, and export their blend", {"measurability"});
+args::Flag	         	        argDescriptors(argParser, "", "Export terrain descriptor maps: slope, TRI, TPI, roughness and curvature (T1 - T5)", {"descriptors"});
+args::ValueFlag	<double>        argDescriptorSize(argParser, "size", "Size [m] of the square window of the terrain descriptors. Default: vehicle footprint", {"descriptor_size"});
 
 //*************************************** tiff2png specific parser
 args::ArgumentParser    argParserT2P("","");
@@ -97,6 +109,18 @@ args::ValueFlag	<std::string> 	argMethodIRS(argParserIRS,"interpolation_method",
 args::ValueFlag	<unsigned int>  argXSizeIRS(argParserIRS,"pixels", "ROI width (X) in pixels",                   {"size_x"});
 args::ValueFlag	<unsigned int>  argYSizeIRS(argParserIRS,"pixels", "ROI height (Y) in pixels",                  {"size_y"});
 
+//*************************************** hull_bench specific parser
+args::ArgumentParser            argParserHB("","");
+args::HelpFlag 	                argHelpHB(argParserHB, "help", "Display this help menu", {'h', "help"});
+args::CompletionFlag            completionHB(argParserHB, {"complete"});
+
+args::ValueFlag <std::string> 	argInputHB(argParserHB, "input", "Input geoTIFF image, typ bathymetry map",   {'i', "input"});
+args::ValueFlag	<int> 	        argVerboseHB(argParserHB,   "verbose",  "Define verbosity level",             {'v', "verbose"});
+args::ValueFlag	<double>        argWidthHB(argParserHB,  "meters", "Width of the vehicle footprint. Default: 0.5",     {"width"});
+args::ValueFlag	<double>        argLengthHB(argParserHB, "meters", "Length of the vehicle footprint. Default: 1.4",    {"length"});
+args::ValueFlag	<int>           argSamplesHB(argParserHB,"number", "Approximate number of benchmarked windows. Default: 500", {"samples"});
+args::ValueFlag	<int>           argRepeatHB(argParserHB, "number", "Timed passes over the windows, the fastest is kept. Default: 3", {"repeat"});
+
 /**
  * @brief Default initializer for argument parsing object
  * 
@@ -255,4 +279,52 @@ int initParserIRS(int argc, char *argv[], string newDescription = ""){
 }
 
 
+/**
+ * @brief Inititalize argument parser for hull_bench module
+ * 
+ * @param argc cli argc (count)
+ * @param argv cli argv (values)
+ * @return int error code if any
+ */
+int initParserHB(int argc, char *argv[]){
+    /* PARSER section */
+    std::string descriptionString =
+        "hull_bench - Benchmark of the CGAL convex hull plane solvers of FILTER_CONVEX_SLOPE. \
+        Former per call mesh + AABB ray query against the recycled mesh + facet scan, on windows sampled from a geoTIFF bathymetry map";
+
+    argParserHB.Description(descriptionString);
+    argParserHB.Epilog("Author: J. Cappelletto (GitHub: @cappelletto)\n");
+    argParserHB.Prog(argv[0]);
+    argParserHB.helpParams.width = 120;
+
+    try
+    {
+        argParserHB.ParseCLI(argc, argv);
+    }
+    catch (const args::Completion &e)
+    {
+        cout << e.what();
+        return 0;
+    }
+    catch (args::Help)
+    { // if argument asking for help, show this message
+        cout << argParserHB;
+        return lad::ERROR_MISSING_ARGUMENT;
+    }
+    catch (args::ParseError e)
+    { //if some error ocurr while parsing, show summary
+        std::cerr << e.what() << std::endl;
+        std::cerr << "Use -h, --help command to see usage" << std::endl;
+        return lad::ERROR_WRONG_ARGUMENT;
+    }
+    catch (args::ValidationError e)
+    { // if some error at argument validation, show
+        std::cerr << "Bad input commands" << std::endl;
+        std::cerr << "Use -h, --help command to see usage" << std::endl;
+        return lad::ERROR_WRONG_ARGUMENT;
+    }
+    return 0;
+}
+
+
 #endif //_PROJECT_OPTIONS_H_
\ No newline at end of file
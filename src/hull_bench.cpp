@@ -0,0 +1,226 @@
+/**
+ * @file hull_bench.cpp
+ * @author Jose Cappelletto (cappelletto@gmail.com)
+ * @brief Benchmark of the CGAL convex hull plane solvers of FILTER_CONVEX_SLOPE. The former implementation (new hull mesh
+ * and AABB tree per window, vertical ray query) is compared against the current one (recycled per thread mesh, direct
+ * facet scan) on the same windows, sampled on a regular grid of a geoTIFF bathymetry map. Every heap allocation done
+ * through operator new is counted, so the steady state allocations per window of each solver are reported along the timings
+ * @version 0.1
+ * @date 2024-03-18
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "headers.h"
+#include "helper.h"
+
+#include "options.h"
+#include "geotiff.hpp"
+#include "lad_core.hpp"
+#include "lad_config.hpp"
+#include "lad_enum.hpp"
+#include "lad_processing.hpp"
+#include "lad_window.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+using namespace cv;
+using namespace lad;
+
+logger::ConsoleOutput logc;
+
+// counting allocator: every operator new of the process goes through these counters
+static std::atomic<long> allocCount(0);
+static std::atomic<long> allocBytes(0);
+
+void *operator new(std::size_t size)
+{
+    allocCount++;
+    allocBytes += size;
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    allocCount++;
+    allocBytes += size;
+    return std::malloc(size ? size : 1);
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept
+{
+    std::free(p);
+}
+
+/**
+ * @brief Timings and allocations of one solver over every benchmarked window
+ *
+ */
+typedef struct hullBenchResult_
+{
+    double seconds; //!< Fastest timed pass [s]
+    long allocs;    //!< Calls to operator new during one timed pass
+    long bytes;     //!< Bytes requested to operator new during one timed pass
+} HullBenchResult;
+
+/**
+ * @brief Run a solver over every window: one warm-up pass (the recycled mesh reaches its steady capacity), and then
+ * nRepeat timed passes. The allocations are counted over the last timed pass
+ *
+ * @param windows Points of every window, relative to the window center and shifted by their Z-mean
+ * @param solver Convex hull plane solver
+ * @param nRepeat Number of timed passes
+ * @param planes Resulting plane of every window
+ * @return HullBenchResult Timings and allocations
+ */
+template <class Solver>
+HullBenchResult runHullBench(const vector<vector<KPoint>> &windows, Solver solver, int nRepeat, vector<KPlane> &planes)
+{
+    // same query point used by computeConvexHullPlane for the CGAL solver
+    double qx = 0.0001;
+    double qy = 0.0001;
+    planes.resize(windows.size());
+    for (int i = 0; i < windows.size(); i++)
+        planes[i] = solver(windows[i], qx, qy);
+
+    HullBenchResult result = {-1, 0, 0};
+    for (int k = 0; k < nRepeat; k++)
+    {
+        long count0 = allocCount, bytes0 = allocBytes;
+        auto start_ = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < windows.size(); i++)
+            planes[i] = solver(windows[i], qx, qy);
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start_;
+        result.allocs = allocCount - count0;
+        result.bytes = allocBytes - bytes0;
+        if (result.seconds < 0 || elapsed.count() < result.seconds)
+            result.seconds = elapsed.count();
+    }
+    return result;
+}
+
+/*!
+    @fn     int main(int argc, char* argv[])
+    @brief  Main function
+*/
+int main(int argc, char *argv[])
+{
+    int retval = initParserHB(argc, argv); // initial argument validation, populates arg parsing structure args
+    if (retval != 0)                       // some error ocurred, we have been signaled to stop
+        return retval;
+    std::ostringstream s;
+    int verbosity = 0;
+    if (argVerboseHB)
+        verbosity = args::get(argVerboseHB);
+    string inputFileName = "";
+    if (argInputHB)
+        inputFileName = args::get(argInputHB);
+    if (inputFileName.empty())
+    {
+        logc.error("main", "Input file missing. Please define it using --input='filename'");
+        return ERROR_MISSING_ARGUMENT;
+    }
+    parameterStruct params = getDefaultParams();
+    double width = argWidthHB ? args::get(argWidthHB) : params.robotWidth;
+    double length = argLengthHB ? args::get(argLengthHB) : params.robotLength;
+    int nSamples = argSamplesHB ? args::get(argSamplesHB) : 500;
+    int nRepeat = argRepeatHB ? std::max(1, args::get(argRepeatHB)) : 3;
+
+    lad::Pipeline pipeline;
+    pipeline.verbosity = verbosity;
+    pipeline.useNodataMask = true;
+    if (pipeline.readTIFF(inputFileName, "M1_RAW_Bathymetry", "M1_VALID_DataMask") != NO_ERROR)
+    {
+        s << "Could not read input file [" << yellow << inputFileName << red << "]";
+        logc.error("main", s);
+        return ERROR_WRONG_ARGUMENT;
+    }
+    auto apSrc = dynamic_pointer_cast<RasterLayer>(pipeline.getLayer("M1_RAW_Bathymetry"));
+    pipeline.createKernelTemplate("KernelAUV", width, length, cv::MORPH_RECT);
+    auto apKernel = dynamic_pointer_cast<KernelLayer>(pipeline.getLayer("KernelAUV"));
+    if (apSrc == nullptr || apKernel == nullptr || apSrc->rasterData.empty())
+    {
+        logc.error("main", "Empty input raster or invalid vehicle footprint");
+        return ERROR_WRONG_ARGUMENT;
+    }
+    apKernel->setRotation(0);
+
+    // windows anchored on a regular grid over the raster, gathered as the convex slope filter does
+    const cv::Mat &raster = apSrc->rasterData;
+    double nodata = apSrc->getNoDataValue();
+    double sx = pipeline.geoTransform[1];
+    double sy = pipeline.geoTransform[5];
+    int nRows = raster.rows;
+    int nCols = raster.cols;
+    int step = std::max(1, (int)sqrt((double)nRows * nCols / std::max(nSamples, 1)));
+    KernelFootprint window = apKernel->bank.window;
+    window.setStride(raster.step1(), getRasterHalo(raster));
+    vector<vector<KPoint>> windows;
+    long nPoints = 0;
+    for (int row = step / 2; row < nRows; row += step)
+    {
+        for (int col = step / 2; col < nCols; col += step)
+        {
+            if (isNoData(raster.at<raster_t>(row, col), nodata))
+                continue;
+            vector<KPoint> points, sensor;
+            double acum = 0;
+            gatherFootprintPoints(raster, nodata, row, col, window, nRows, nCols, row, col, sx, sy, points, &acum, sensor, 0);
+            if (points.size() <= 5) // same minimum number of points required by the filter
+                continue;
+            KVector zmean(0, 0, acum / points.size());
+            for (auto &p : points)
+                p = p - zmean;
+            nPoints += points.size();
+            windows.push_back(std::move(points));
+        }
+    }
+    if (windows.empty())
+    {
+        logc.error("main", "No valid window to benchmark");
+        return ERROR_WRONG_ARGUMENT;
+    }
+
+    vector<KPlane> planesAABB, planesScan;
+    HullBenchResult aabb = runHullBench(windows, computeConvexHullPlaneAABB, nRepeat, planesAABB);
+    HullBenchResult scan = runHullBench(windows, computeConvexHullPlaneCGAL, nRepeat, planesScan);
+
+    // both solvers must return the same facet, up to the ties of the query point on a shared edge
+    double maxDev = 0;
+    int nDiff = 0;
+    for (int i = 0; i < windows.size(); i++)
+    {
+        double dev = fabs(computePlaneSlope(planesAABB[i], KVector(0, 0, 1)) - computePlaneSlope(planesScan[i], KVector(0, 0, 1)));
+        maxDev = std::max(maxDev, dev);
+        nDiff += (dev > 1e-6);
+    }
+
+    int n = windows.size();
+    cout << "Input:          \t" << inputFileName << " [" << nCols << " x " << nRows << "]" << endl;
+    cout << "Footprint:      \t" << width << " x " << length << " m, " << nPoints / n << " points/window (mean)" << endl;
+    cout << "Windows:        \t" << n << ", best of " << nRepeat << " passes" << endl;
+    cout << "Solver          \t  total [s]\t  us/window\tallocs/window\tbytes/window" << endl;
+    for (auto r : {std::make_pair("AABB (former)", aabb), std::make_pair("Facet scan", scan)})
+    {
+        cout << r.first << "   \t" << std::setw(11) << r.second.seconds << "\t" << std::setw(11) << 1e6 * r.second.seconds / n << "\t"
+             << std::setw(13) << (double)r.second.allocs / n << "\t" << std::setw(12) << (double)r.second.bytes / n << endl;
+    }
+    cout << "Speedup:        \t" << aabb.seconds / std::max(scan.seconds, 1e-12) << "x" << endl;
+    cout << "Slope mismatch: \t" << nDiff << " windows, max " << maxDev << " deg" << endl;
+    return NO_ERROR;
+}
@@ -0,0 +1,272 @@
+/**
+ * @file lad_autotune.cpp
+ * @author Jose Cappelletto (cappelletto@gmail.com)
+ * @brief Startup calibration of the window filter strategy of the Landing Area Detection (lad) algorithm
+ * @version 0.1
+ * @date 2024-03-18
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "lad_autotune.hpp"
+#include "lad_simd.hpp"
+
+#include <yaml-cpp/yaml.h>
+#ifdef _WIN32
+#include <cstdlib>
+#else
+#include <unistd.h>
+#endif
+
+namespace lad
+{
+    /**
+     * @brief Signature of the machine a calibration was measured on: host name, number of OpenMP threads and SIMD
+     * instruction set of the kernels (see lad_simd.hpp). Any change of them invalidates the cached calibrations
+     *
+     * @return std::string Machine signature
+     */
+    std::string getMachineSignature()
+    {
+        std::string host = "unknown";
+#ifdef _WIN32
+        const char *name = getenv("COMPUTERNAME");
+        if (name != nullptr)
+            host = name;
+#else
+        char name[256];
+        if (gethostname(name, sizeof(name)) == 0)
+        {
+            name[sizeof(name) - 1] = 0;
+            host = name;
+        }
+#endif
+        std::ostringstream s;
+        s << host << "/" << omp_get_max_threads() << "t/" << getSimdIsaName(getSimdKernels().isa);
+        return s.str();
+    }
+
+    /**
+     * @brief Density bucket of a raster: the ratio of valid pixels, in 10% steps
+     *
+     * @param nValid Number of valid pixels
+     * @param nPixels Total number of pixels
+     * @return int Bucket [0, 9], 9 for 90% or more valid pixels
+     */
+    int getDensityBucket(long nValid, long nPixels)
+    {
+        if (nPixels <= 0)
+            return 0;
+        return std::min(9, std::max(0, (int)(10 * nValid / nPixels)));
+    }
+
+    /**
+     * @brief Check if an entry of the cache file was calibrated for a key. Entries written before the heading count and
+     * the batching were part of the key never match
+     */
+    static bool isSameKey(const YAML::Node &entry, const AutotuneKey &key)
+    {
+        return entry["machine"].as<std::string>() == key.machine && entry["kernel_px"].as<int>() == key.kernelPixels &&
+               entry["density"].as<int>() == key.densityBucket && entry["headings"].as<int>(0) == key.nHeadings &&
+               entry["batched"].as<bool>(!key.batched) == key.batched;
+    }
+
+    /**
+     * @brief Look up the calibration of a key in the cache file. A missing or unreadable file is a cache miss
+     *
+     * @param file Path of the YAML cache file
+     * @param key Conditions of the calibration
+     * @param choice Cached strategy, with cached set to true
+     * @return int NO_ERROR if the key was found, ERROR_MISSING_ARGUMENT otherwise
+     */
+    int readAutotuneCache(const std::string &file, const AutotuneKey &key, AutotuneChoice &choice)
+    {
+        try
+        {
+            YAML::Node cache = YAML::LoadFile(file);
+            if (!cache["autotune"] || !cache["autotune"].IsSequence())
+                return ERROR_MISSING_ARGUMENT;
+            for (const auto &entry : cache["autotune"])
+            {
+                if (!isSameKey(entry, key))
+                    continue;
+                choice.windowEngine = (entry["engine"].as<std::string>() == "GATHER") ? ENGINE_GATHER : ENGINE_MOMENTS;
+                choice.tileSize = entry["tile_size"].as<int>();
+                choice.seconds = entry["seconds"].as<double>();
+                choice.cached = true;
+                return NO_ERROR;
+            }
+        }
+        catch (const YAML::Exception &)
+        {
+        }
+        return ERROR_MISSING_ARGUMENT;
+    }
+
+    /**
+     * @brief Store the calibration of a key in the cache file. A previous calibration of the same key is replaced, the
+     * calibrations of other keys are kept
+     *
+     * @param file Path of the YAML cache file
+     * @param key Conditions of the calibration
+     * @param choice Selected strategy
+     * @return int NO_ERROR, or ERROR_WRONG_ARGUMENT if the file could not be written
+     */
+    int writeAutotuneCache(const std::string &file, const AutotuneKey &key, const AutotuneChoice &choice)
+    {
+        YAML::Node entries(YAML::NodeType::Sequence);
+        try
+        {
+            YAML::Node cache = YAML::LoadFile(file);
+            if (cache["autotune"] && cache["autotune"].IsSequence())
+                for (const auto &entry : cache["autotune"])
+                    if (!isSameKey(entry, key))
+                        entries.push_back(entry);
+        }
+        catch (const YAML::Exception &)
+        {
+            // missing or corrupted cache, it is rewritten from scratch
+        }
+
+        YAML::Node entry;
+        entry["machine"] = key.machine;
+        entry["kernel_px"] = key.kernelPixels;
+        entry["density"] = key.densityBucket;
+        entry["headings"] = key.nHeadings;
+        entry["batched"] = key.batched;
+        entry["engine"] = (choice.windowEngine == ENGINE_GATHER) ? "GATHER" : "MOMENTS";
+        entry["tile_size"] = choice.tileSize;
+        entry["seconds"] = choice.seconds;
+        entries.push_back(entry);
+
+        YAML::Node cache;
+        cache["autotune"] = entries;
+        std::ofstream out(file);
+        if (!out.is_open())
+            return ERROR_WRONG_ARGUMENT;
+        out << cache << std::endl;
+        return out.good() ? NO_ERROR : ERROR_WRONG_ARGUMENT;
+    }
+
+    /**
+     * @brief Region of the raster used to calibrate the window filters: the square with the most valid pixels among those
+     * placed on a half-side grid over the bounding box of the valid data, sized so a gathering run visits about
+     * AUTOTUNE_SAMPLE_BUDGET points. Diagonal or sparse swaths leave most of their bounding box empty, so a centered
+     * square could time mostly NODATA windows
+     *
+     * @param index Valid pixel index of the raster
+     * @param kernelPixels Number of pixels of the kernel footprint
+     * @return cv::Rect Sample region, clipped to the raster. Empty if the raster has no valid data
+     */
+    cv::Rect getAutotuneSample(const ValidIndex &index, int kernelPixels)
+    {
+        if (index.nValid == 0)
+            return cv::Rect();
+        cv::Rect bbox = cv::boundingRect(index.mask);
+        if (bbox.empty())
+            return cv::Rect();
+        int side = (int)sqrt((double)AUTOTUNE_SAMPLE_BUDGET / std::max(1, kernelPixels));
+        side = std::min((int)AUTOTUNE_SAMPLE_MAX, std::max((int)AUTOTUNE_SAMPLE_MIN, side));
+        int w = std::min(side, bbox.width);
+        int h = std::min(side, bbox.height);
+        int stepX = std::max(1, w / 2), stepY = std::max(1, h / 2);
+        cv::Rect best;
+        long bestCount = -1;
+        for (int y = bbox.y;; y = std::min(y + stepY, bbox.br().y - h))
+        {
+            for (int x = bbox.x;; x = std::min(x + stepX, bbox.br().x - w))
+            {
+                long count = index.countRect(y, y + h, x, x + w);
+                if (count > bestCount)
+                {
+                    bestCount = count;
+                    best = cv::Rect(x, y, w, h);
+                }
+                if (x == bbox.br().x - w)
+                    break;
+            }
+            if (y == bbox.br().y - h)
+                break;
+        }
+        return best;
+    }
+
+    /**
+     * @brief Measure the FILTER_SLOPE window filter of a sample raster for every candidate strategy (window engine x tile
+     * size), and keep the fastest. The moment engine is timed as land runs it: with batched set, a single pass evaluates
+     * every heading footprint (see the heading-batched computeMomentFilter); otherwise one heading is evaluated per pass.
+     * The moment table is built once per raster and shared by every heading, so its cost is spread over the headings.
+     * Every strategy runs AUTOTUNE_REPEATS times and its fastest run is kept
+     *
+     * @param sample Sample of the source elevation raster (RASTER_TYPE), see getAutotuneSample. Windows near its border
+     * read the surrounding samples of the raster when the footprint margin allows it, as in the complete filter
+     * @param nodata No-data value of the raster
+     * @param windows Window footprint of the kernel (KernelBank::window) at every heading of the run
+     * @param gatherWindow Footprint used by the gathering engine, the first window itself or its subsample (pointBudget)
+     * @param sx Horizontal pixel scale
+     * @param sy Vertical pixel scale
+     * @param batched True if the moment engine evaluates every heading in a single pass
+     * @param choice Fastest strategy, with its time [s] per heading
+     * @param trials Optional output, every measured strategy
+     * @return int Error code, ERROR_WRONG_ARGUMENT if the sample or the footprints are empty
+     */
+    int benchmarkWindowStrategies(const cv::Mat &sample, double nodata, const std::vector<KernelFootprint> &windows, const KernelFootprint &gatherWindow,
+                                  double sx, double sy, bool batched, AutotuneChoice &choice, std::vector<AutotuneChoice> *trials)
+    {
+        if (sample.empty() || windows.empty())
+            return ERROR_WRONG_ARGUMENT;
+        int nHeadings = windows.size();
+        ValidIndex index;
+        index.build(sample, nodata);
+        if (index.nValid == 0)
+            return ERROR_WRONG_ARGUMENT;
+
+        auto start_ = std::chrono::high_resolution_clock::now();
+        MomentTable table;
+        table.build(sample, nodata);
+        std::chrono::duration<double> tableTime = std::chrono::high_resolution_clock::now() - start_;
+
+        // complete rows, and square tiles that fit in the sample
+        std::vector<int> tileSizes = {0};
+        for (int t : {32, 64, 128})
+            if (t < std::max(sample.rows, sample.cols))
+                tileSizes.push_back(t);
+
+        choice.seconds = -1;
+        choice.cached = false;
+        cv::Mat dst(sample.size(), RASTER_TYPE);
+        std::vector<cv::Mat> dsts;
+        for (WindowEngine engine : {ENGINE_MOMENTS, ENGINE_GATHER})
+        {
+            for (int tileSize : tileSizes)
+            {
+                double best = -1;
+                for (int k = 0; k < AUTOTUNE_REPEATS; k++)
+                {
+                    dst.setTo(RASTER_NODATA);
+                    auto begin = std::chrono::high_resolution_clock::now();
+                    if (engine == ENGINE_MOMENTS && batched)
+                        computeMomentFilter(sample, nodata, table, windows, sx, sy, FILTER_SLOPE, dsts, tileSize, &index);
+                    else if (engine == ENGINE_MOMENTS)
+                        computeMomentFilter(sample, nodata, table, windows[0], sx, sy, FILTER_SLOPE, dst, tileSize, &index);
+                    else
+                        computeWindowFilter(sample, nodata, gatherWindow, sx, sy, SlopePolicy(), dst, tileSize, cv::Mat(), &index);
+                    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - begin;
+                    if (best < 0 || elapsed.count() < best)
+                        best = elapsed.count();
+                }
+                if (engine == ENGINE_MOMENTS && batched)
+                    best = (best + tableTime.count()) / nHeadings;
+                else if (engine == ENGINE_MOMENTS)
+                    best += tableTime.count() / nHeadings;
+
+                AutotuneChoice trial = {engine, tileSize, best, false};
+                if (trials != nullptr)
+                    trials->push_back(trial);
+                if (choice.seconds < 0 || best < choice.seconds)
+                    choice = trial;
+            }
+        }
+        return NO_ERROR;
+    }
+}
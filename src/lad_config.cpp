@@ -51,6 +51,17 @@ void lad::printParams(parameterStruct_ *p)
     cout << "\tslopeThreshold: \t" << p->slopeThreshold << "\t[deg]" << reset << endl;
     cout << "\tgroundThreshold:\t" << p->groundThreshold << "\t[m]" << endl;
     cout << "\tprotrusionSize: \t" << p->protrusionSize << "\t[m]" << endl;
+    cout << "\twindowEngine:   \t" << (p->windowEngine == ENGINE_MOMENTS ? "MOMENTS" : "GATHER") << endl;
+    cout << "\thullSweep:      \t" << (p->hullSweep ? "true" : "false") << endl;
+    cout << "\thullSolver:     \t" << (p->hullSolver == HULL_CGAL ? "CGAL" : "ENVELOPE") << endl;
+    cout << "\tplaneCache:     \t" << (p->planeCache.empty() ? "disabled" : p->planeCache) << endl;
+    cout << "\tpointBudget:    \t" << (p->pointBudget > 0 ? std::to_string(p->pointBudget) : "disabled") << endl;
+    cout << "\ttileSize:       \t" << p->tileSize << "\t[px]" << endl;
+    cout << "\tslopeScreening: \t" << (p->slopeScreening > 0 ? std::to_string(p->slopeScreening) + "\t[deg]" : "disabled") << endl;
+    cout << "\texclusionGating:\t" << (p->exclusionGating ? "true" : "false") << endl;
+    cout << "\tmeasurability:  \t" << (p->measurability ? "true" : "false") << endl;
+    cout << "\tquantization:   \t" << (p->quantizationStep > 0 ? std::to_string(p->quantizationStep) + "\t[m]" : "disabled") << endl;
+    cout << "\tautotune:       \t" << (p->autotune ? p->autotuneCache : "disabled") << endl;
 
     cout << "Sensor parameters" << endl;
     cout << "\tdiameter:\t" << p->geotechSensor.diameter << "\t[m]" << endl;
@@ -92,6 +103,8 @@ YAML::Node lad::readConfiguration(std::string file, parameterStruct *p)
             p->exportRotated = config["general"]["export"]["rotated"].as<bool>();
         if (config["general"]["recomputethresh"])
             p->updateThreshold = config["general"]["recomputethresh"].as<bool>();
+        if (config["general"]["measurability"])
+            p->measurability = config["general"]["measurability"].as<bool>();
     }
 
     if (config["vehicle"])
@@ -180,6 +193,50 @@ YAML::Node lad::readConfiguration(std::string file, parameterStruct *p)
         }
     }
 
+    if (config["filter"])
+    {
+        if (verb > 0)
+            cout << "[readConfiguration] Filter section present" << endl;
+        if (config["filter"]["engine"])
+        {
+            std::string engine = config["filter"]["engine"].as<std::string>();
+            if (engine == "MOMENTS")
+                p->windowEngine = ENGINE_MOMENTS;
+            else if (engine == "GATHER")
+                p->windowEngine = ENGINE_GATHER;
+            else
+                cout << "[readConfiguration] Unknown filter:engine [" << engine << "]. Keeping current value" << endl;
+        }
+        if (config["filter"]["hull_sweep"])
+            p->hullSweep = config["filter"]["hull_sweep"].as<bool>();
+        if (config["filter"]["hull_solver"])
+        {
+            std::string solver = config["filter"]["hull_solver"].as<std::string>();
+            if (solver == "ENVELOPE")
+                p->hullSolver = HULL_ENVELOPE;
+            else if (solver == "CGAL")
+                p->hullSolver = HULL_CGAL;
+            else
+                cout << "[readConfiguration] Unknown filter:hull_solver [" << solver << "]. Keeping current value" << endl;
+        }
+        if (config["filter"]["plane_cache"])
+            p->planeCache = config["filter"]["plane_cache"].as<std::string>();
+        if (config["filter"]["point_budget"])
+            p->pointBudget = config["filter"]["point_budget"].as<int>();
+        if (config["filter"]["tile_size"])
+            p->tileSize = config["filter"]["tile_size"].as<int>();
+        if (config["filter"]["slope_screening"])
+            p->slopeScreening = config["filter"]["slope_screening"].as<double>();
+        if (config["filter"]["exclusion_gating"])
+            p->exclusionGating = config["filter"]["exclusion_gating"].as<bool>();
+        if (config["filter"]["quantization_step"])
+            p->quantizationStep = config["filter"]["quantization_step"].as<double>();
+        if (config["filter"]["autotune"])
+            p->autotune = config["filter"]["autotune"].as<bool>();
+        if (config["filter"]["autotune_cache"])
+            p->autotuneCache = config["filter"]["autotune_cache"].as<std::string>();
+    }
+
     if (config["geotechsensor"])
     { // explicit definition of geotechnical sensor parameters
         if (verb > 0)
@@ -227,6 +284,18 @@ lad::parameterStruct lad::getDefaultParams()
     params.heightThreshold = 0.10;                         // DEFAULT;
     params.slopeThreshold = 17.7;                          // DEFAULT;
     params.slopeAlgorithm = lad::FilterType::FILTER_SLOPE; // DEFAULT
+    params.windowEngine = lad::WindowEngine::ENGINE_MOMENTS; // DEFAULT
+    params.hullSweep = true;                               // DEFAULT
+    params.hullSolver = lad::HullSolver::HULL_CGAL;        // DEFAULT
+    params.planeCache = "";                                // DEFAULT (disabled)
+    params.pointBudget = 0;                                // DEFAULT (disabled)
+    params.tileSize = DEFAULT_TILE_SIZE;                   // DEFAULT
+    params.slopeScreening = 0;                             // DEFAULT (disabled)
+    params.exclusionGating = false;                        // DEFAULT
+    params.measurability = false;                          // DEFAULT
+    params.quantizationStep = 0;                           // DEFAULT (disabled)
+    params.autotune = false;                               // DEFAULT
+    params.autotuneCache = ".lad_autotune.yaml";           // DEFAULT
     params.robotHeight = 0.8;                              // DEFAULT
     params.robotLength = 1.4;
     params.robotWidth = 0.5;
@@ -189,6 +189,12 @@ namespace lad
         {
             mapLayers.erase(name);
         }
+#pragma omp critical(windowCaches)
+        {
+            momentTables.erase(name);
+            sensorFootprints.erase(name);
+            validIndexes.erase(name);
+        }
 
         return NO_ERROR;
     }
@@ -618,15 +624,16 @@ namespace lad
             logc.error("readTIFF", s);
         }
 
-        if (apRaster->readTIFF(inputFile) != NO_ERROR)
+        // the elevation quantisation (if enabled) applies to the imported raster only
+        if (apRaster->readTIFF(inputFile, parameters.quantizationStep) != NO_ERROR)
         {
             s << "Error reading file [" << inputFile << "]";
             logc.error("readTIFF", s);
             return ERROR_GDAL_FAILOPEN;
         }
         // transfer the recently computed mask layer from the source raster layer
-        apRaster->rasterMask.copyTo(apMask->rasterData);
-        apRaster->rasterMask.copyTo(apMask->rasterMask);
+        apRaster->getMask().copyTo(apMask->rasterData);
+        apMask->setMask(apRaster->getMask());
         // apMask->rasterMask = cv::Mat::ones(apMask->rasterData.size(), CV_8UC1);
         // update layerDimensions array, as they are needed when exporting as geoTIFF
         // \todo use actual size from the raster container?
@@ -636,9 +643,8 @@ namespace lad
         apMask->copyGeoProperties(apRaster);
         apMask->setNoDataValue(DEFAULT_NODATA_VALUE);
 
-        // create a global (pipeline-wise)
-        roi_image = cv::Mat(apRaster->rasterData.size(), CV_8UC1);                        // create global valid_data maskthat won't be updated
-        cv::compare(apRaster->rasterData, apRaster->getNoDataValue(), roi_image, CMP_NE); // ROI at the source data level
+        // index of the valid pixels, shared by every window filter applied to the raster (see ValidIndex)
+        getValidIndex(apRaster);
 
         return NO_ERROR;
     }
@@ -950,14 +956,16 @@ namespace lad
             return ERROR_WRONG_ARGUMENT;
         }
 
-        cv::erode(apLayerR->rasterData, apLayerO->rasterData, apLayerK->rotatedData);
+        // span based erosion for binary masks, dense OpenCV erosion otherwise
+        if (erodeMask(apLayerR->rasterData, apLayerK->bank.shape, apLayerO->rasterData) != NO_ERROR)
+            cv::erode(apLayerR->rasterData, apLayerO->rasterData, apLayerK->rotatedData);
         // we do not need to set nodata field for destination layer if we use it as mask
         // if we use it for other purposes (QGIS related), we can use a negative value to flag it
         // logc.debug("p:comExcl", dstLayer);
 
         apLayerO->copyGeoProperties(apLayerR); // let's copy the geoproperties
         apLayerO->setNoDataValue(DEFAULT_NODATA_VALUE);
-        apLayerR->rasterMask.copyTo(apLayerO->rasterMask); // transfer mask
+        apLayerO->setMask(apLayerR->getMask()); // transfer mask
 
         //  = cv::Mat::ones(apLayerO->rasterData.size(), CV_8UC1);
         if (verbosity > 1)
@@ -1018,7 +1026,7 @@ namespace lad
             if (useNodataMask)
             {
                 // apLayer->updateMask();
-                cv::normalize(dst, dst, 0, 255, NORM_MINMAX, CV_8UC1, apLayer->rasterMask); // normalize within the expected range 0-255 for imshow
+                cv::normalize(dst, dst, 0, 255, NORM_MINMAX, CV_8UC1, apLayer->getMask()); // normalize within the expected range 0-255 for imshow
             }
             else
             {
@@ -1109,7 +1117,7 @@ namespace lad
             if (useNodataMask)
             {
                 // apLayer->updateMask();
-                cv::normalize(dst, dst, 0, 255, NORM_MINMAX, CV_8UC1, apLayer->rasterMask); // normalize within the expected range 0-255 for imshow
+                cv::normalize(dst, dst, 0, 255, NORM_MINMAX, CV_8UC1, apLayer->getMask()); // normalize within the expected range 0-255 for imshow
             }
             else
             {
@@ -1176,8 +1184,8 @@ namespace lad
     /**
      * @brief Copy the rasterMask from src to dst layers. The mask is assumed to be CV8UC1 where any non-NULL value is treated as true
      *
-     * @param src Name of the source layer. The rasterMask cv::Mat will be copied, not the actual rasterData matrix
-     * @param dst Name of the target layer (any type) where a copy of the rasterMask will be stored
+     * @param src Name of the source layer. The rasterMask cv::Mat will be shared (see RasterLayer::setMask), not the actual rasterData matrix
+     * @param dst Name of the target layer (any type) where the rasterMask will be stored
      * @return int Error code, if any.
      */
     int Pipeline::copyMask(std::string src, std::string dst)
@@ -1200,7 +1208,52 @@ namespace lad
             return ERROR_WRONG_ARGUMENT;
         }
 
-        apSrc->rasterMask.copyTo(apDst->rasterMask);
+        apDst->setMask(apSrc->getMask());
+        return NO_ERROR;
+    }
+
+    /**
+     * @brief Surround a raster layer with a NODATA halo wide enough for every heading of a kernel (half its diagonal),
+     * so the window filters can read the footprint of border pixels without clipping it
+     * @details It must be called before any concurrent access to the raster, as its storage is reallocated
+     *
+     * @param raster Name of the raster layer to be padded, typically the source bathymetry
+     * @param kernel Name of the (unrotated) kernel layer, typically the vehicle footprint
+     * @return int Error code, if any
+     */
+    int Pipeline::padLayer(std::string raster, std::string kernel)
+    {
+        ostringstream s;
+        auto apRaster = dynamic_pointer_cast<RasterLayer>(getLayer(raster));
+        if (apRaster == nullptr)
+        {
+            s << "Raster layer not found: [" << raster << "]";
+            logc.error("p::padLayer", s);
+            return ERROR_WRONG_ARGUMENT;
+        }
+        auto apKernel = dynamic_pointer_cast<KernelLayer>(getLayer(kernel));
+        if (apKernel == nullptr)
+        {
+            s << "Kernel layer not found: [" << kernel << "]";
+            logc.error("p::padLayer", s);
+            return ERROR_WRONG_ARGUMENT;
+        }
+        // any rotation of the kernel fits in the circle of its diagonal (+1 px for the rotation rounding)
+        int halo = (int)ceil(apKernel->getDiagonalSize() / 2) + 1;
+        if (apRaster->getHalo() >= halo)
+            return NO_ERROR;
+        int r = apRaster->setHalo(halo);
+        if (r != NO_ERROR)
+        {
+            s << "Unable to pad raster layer [" << raster << "]";
+            logc.error("p::padLayer", s);
+            return r;
+        }
+        if (verbosity > VERBOSITY_1)
+        {
+            s << "Raster layer [" << raster << "] padded with a halo of " << halo << " px";
+            logc.debug("p::padLayer", s);
+        }
         return NO_ERROR;
     }
 
@@ -1253,7 +1306,7 @@ namespace lad
             return LAYER_INVALID;
         }
 
-        apDst->rasterData = cv::Mat(apSrc->rasterData.size(), CV_64FC1, apSrc->getNoDataValue());
+        apDst->rasterData = cv::Mat(apSrc->rasterData.size(), RASTER_TYPE, apSrc->getNoDataValue());
         apDst->copyGeoProperties(apSrc);
         apDst->setNoDataValue(apSrc->getNoDataValue());
 
@@ -1327,7 +1380,7 @@ namespace lad
         apDst->setNoDataValue(DEFAULT_NODATA_VALUE);
         cv::compare(apSrc->rasterData, threshold, apDst->rasterData, cmp); // create a no-data mask
         // we need to propagate the NODATA mask from the source
-        apSrc->rasterMask.copyTo(apDst->rasterMask);
+        apDst->setMask(apSrc->getMask());
         return NO_ERROR;
     }
 
@@ -1418,7 +1471,12 @@ namespace lad
         }
 
         apDst->copyGeoProperties(apSrc);
-        apDst->setNoDataValue(DEFAULT_NODATA_VALUE);
+        apDst->setNoDataValue(RASTER_NODATA);
+#ifdef USE_NAN_NODATA
+        // NaN samples of either layer propagate through the difference, no validity masks are needed
+        apDst->rasterData = apFilt->rasterData - apSrc->rasterData;
+        return NO_ERROR;
+#endif
         cv::Mat dest; //(apSrc->rasterData.size(), CV_64FC1, DEFAULT_NODATA_VALUE);
         dest = -apSrc->rasterData + apFilt->rasterData;
 
@@ -1427,17 +1485,68 @@ namespace lad
         cv::Mat maskf(apDst->rasterData.size(), CV_8UC1); // final mask
 
         // apSrc->updateMask();
-        cv::compare(apSrc->rasterData, apSrc->getNoDataValue(), mask1, CMP_NE);
-        cv::compare(apFilt->rasterData, apFilt->getNoDataValue(), mask2, CMP_NE);
+        computeValidMask(apSrc->rasterData, apSrc->getNoDataValue(), mask1);
+        computeValidMask(apFilt->rasterData, apFilt->getNoDataValue(), mask2);
         // combine to generate final valid mask
         cv::bitwise_and(mask1, mask2, maskf);
         // use a base constant value layer labeled as NODATA
-        apDst->rasterData = cv::Mat(apSrc->rasterData.size(), CV_64FC1, DEFAULT_NODATA_VALUE);
+        apDst->rasterData = cv::Mat(apSrc->rasterData.size(), RASTER_TYPE, RASTER_NODATA);
         // let's apply the resulting mask
         dest.copyTo(apDst->rasterData, maskf);
         return NO_ERROR;
     }
 
+    /**
+     * @brief Computes the upper and lower convex hull candidate bitmaps of a raster layer. Pixels below (above) the
+     * midpoint of a pair of opposite neighbours are not candidates of the upper (lower) hull of any window. The bitmaps
+     * do not depend on the kernel heading, so they are computed once and reused by every FILTER_CONVEX_SLOPE evaluated
+     * over <src>
+     *
+     * @param src raster layer with the raw bathymetry
+     * @param upper name of the layer that will contain the upper hull candidate bitmap (8UC1, 0/255)
+     * @param lower name of the layer that will contain the lower hull candidate bitmap (8UC1, 0/255)
+     * @return int Error code, if any
+     */
+    int Pipeline::computeHullCandidates(std::string src, std::string upper, std::string lower)
+    {
+        ostringstream s;
+        auto apSrc = dynamic_pointer_cast<RasterLayer>(getLayer(src));
+        if (apSrc == nullptr)
+        {
+            s << "Source raster layer [" << src << "] not found";
+            logc.error("p::computeHullCandidates", s);
+            return LAYER_NOT_FOUND;
+        }
+        for (auto name : {upper, lower})
+        {
+            if (isAvailable(name))
+                createLayer(name, LAYER_RASTER);
+        }
+        auto apUpper = dynamic_pointer_cast<RasterLayer>(getLayer(upper));
+        auto apLower = dynamic_pointer_cast<RasterLayer>(getLayer(lower));
+        if (apUpper == nullptr || apLower == nullptr)
+        {
+            s << "Output layers [" << upper << ", " << lower << "] must be of type LAYER_RASTER";
+            logc.error("p::computeHullCandidates", s);
+            return ERROR_WRONG_ARGUMENT;
+        }
+
+        int pruned = lad::computeHullCandidates(apSrc->rasterData, apSrc->getNoDataValue(), apUpper->rasterData, apLower->rasterData);
+        apUpper->copyGeoProperties(apSrc);
+        apLower->copyGeoProperties(apSrc);
+        apUpper->setNoDataValue(DEFAULT_NODATA_VALUE);
+        apLower->setNoDataValue(DEFAULT_NODATA_VALUE);
+        hullCandidates[src] = upper;
+
+        if (verbosity > VERBOSITY_0)
+        {
+            s << "Upper hull candidates: " << cv::countNonZero(apUpper->rasterData) << "\tLower hull candidates: "
+              << cv::countNonZero(apLower->rasterData) << "\tNon candidates of both: " << pruned;
+            logc.debug("p::computeHullCandidates", s);
+        }
+        return NO_ERROR;
+    }
+
     /**
      * @brief Generate bathymetry map from a plane seed. The resulting flat map can be used for debugging purposes or for height/slope fitting
      *
@@ -1475,7 +1584,7 @@ namespace lad
             return -1;
         }
 
-        apDst->rasterData = cv::Mat(apTemp->rasterData.size(), CV_64FC1, DEFAULT_NODATA_VALUE);
+        apDst->rasterData = cv::Mat(apTemp->rasterData.size(), RASTER_TYPE, RASTER_NODATA);
         apDst->copyGeoProperties(apTemp);
 
         double z; // height (z) will be compute as a function from the plane equation
@@ -1513,8 +1622,8 @@ namespace lad
             {
                 double py = r * sy; // x coordinate of the pixel
                 z = -(planeA * px + planeB * py + planeD) / planeC;
-                apDst->rasterData.at<double>(r, c) = z;
-                // apDst->rasterData.at<double>(cv::Point(c,r)) = z;
+                apDst->rasterData.at<raster_t>(r, c) = z;
+                // apDst->rasterData.at<raster_t>(cv::Point(c,r)) = z;
             }
         }
         return NO_ERROR;
@@ -1528,10 +1637,17 @@ namespace lad
      * @param mask Global raster mask that can be used as ROI
      * @param dst Name of the layer that will store the resulting image
      * @param filtertype type of filter to be applied: mean, slope, etc
+     * @param screenThreshold Slope threshold the output will be compared against. If set (not NaN) and parameters.slopeScreening
+     * is enabled, FILTER_CONVEX_SLOPE windows clearly below the threshold are resolved from a cheap bound (see computeSlopeScreen)
      * @return int Error code, if any
      */
-    int Pipeline::applyWindowFilter(std::string raster, std::string kernel, std::string mask, std::string dst, int filtertype)
+    int Pipeline::applyWindowFilter(std::string raster, std::string kernel, std::string mask, std::string dst, int filtertype, double screenThreshold)
     {
+        // RESIDUAL and PLANE are only provided by the fused pass, which also reuses the plane coefficients of the kernel
+        bool planeFilter = (filtertype == FILTER_SLOPE || filtertype == FILTER_DISTANCE || filtertype == FILTER_GEOTECH);
+        if (filtertype == FILTER_RESIDUAL || filtertype == FILTER_PLANE || (planeFilter && !getPlaneData(raster, kernel).empty()))
+            return applyWindowFilter(raster, kernel, mask, std::map<int, std::string>{{filtertype, dst}});
+
         // first, we retrieve the raster Layer
         ostringstream s;
         auto apSrc = dynamic_pointer_cast<RasterLayer>(getLayer(raster));
@@ -1573,21 +1689,19 @@ namespace lad
             // }
         }
         // we create the empty container for the destination layer
-        apDst->rasterData = cv::Mat(apSrc->rasterData.size(), CV_64FC1, DEFAULT_NODATA_VALUE);
+        apDst->rasterData = cv::Mat(apSrc->rasterData.size(), RASTER_TYPE, RASTER_NODATA);
         // apDst->rasterData = DEFAULT_NODATA_VALUE * cv::Mat::ones(apSrc->rasterData.size(), CV_64FC1);
-        apDst->setNoDataValue(DEFAULT_NODATA_VALUE);
+        apDst->setNoDataValue(RASTER_NODATA);
         double srcNoData = apSrc->getNoDataValue(); // we inherit ource no valid data value
         // logc.debug ("filter", "apDst->copyGeoProperties(apSrc)");
         apDst->copyGeoProperties(apSrc);
         // logc.debug ("filter", "apSrc->rasterMask.copyTo(apDst->rasterMask)");
-        apSrc->rasterMask.copyTo(apDst->rasterMask);
+        apDst->setMask(apSrc->getMask());
         // second, we iterate over the source image
         int nRows = apSrc->rasterData.rows; // faster to have a local copy rather than reading it multiple times inside the for/loop
         int nCols = apSrc->rasterData.cols;
         int hKernel = apKernel->rotatedData.rows; // height of the kernel
         int wKernel = apKernel->rotatedData.cols; // width of the kernel
-        int hKernel_2 = hKernel >> 1;
-        int wKernel_2 = wKernel >> 1;
 
         // on each different position, we apply the kernel as a mask
         if (verbosity > VERBOSITY_0)
@@ -1608,37 +1722,178 @@ namespace lad
             s << "Input raster size: " << apSrc->rasterData.size();
             logc.debug("p::applyWindowFilter", s);
         }
-        int rt, lt, rb, lb;
-        double cx = geoTransform[0];
-        double cy = geoTransform[3];
         double sx = geoTransform[1];
         double sy = geoTransform[5];
 
-        // we create a matrix with NOVALID data
-        cv::Mat roi_image;                                            // = cv::Mat(apSrc->rasterData.size(), CV_8UC1); // create global valid_data mask
-        cv::compare(apSrc->rasterData, srcNoData, roi_image, CMP_NE); // ROI at the source data level
+        // valid data mask and runs of the source, built once per raster. The tiles of the window filters only cover them
+        auto apIndex = getValidIndex(apSrc);
+        const ValidIndex *index = apIndex.get();
+        cv::Mat roi_image = apIndex->mask; // shared with the index, read-only
+        // windows outside the ROI mask (e.g. pixels already excluded by C1_ExclusionMap) are not evaluated, and stay NODATA
+        cv::Mat candidates = getCandidateMask(apSrc, apMask);
+        if (!candidates.empty())
+            cv::bitwise_and(apIndex->mask, candidates, roi_image);
+
+        // MEAN and SLOPE only depend on the first and second order moments of the window, which can be recovered from
+        // row prefix sums without gathering the points. The window footprint of the kernel bank is trimmed to the same
+        // [-h/2, h/2) x [-w/2, w/2) window used by the gathering loop below, so both engines are interchangeable
+        if (parameters.windowEngine == ENGINE_MOMENTS && (filtertype == FILTER_SLOPE || filtertype == FILTER_MEAN))
+        {
+            int r = computeMomentFilter(apSrc->rasterData, srcNoData, *getMomentTable(apSrc), apKernel->bank.window, sx, sy, filtertype, apDst->rasterData,
+                                        parameters.tileSize, index);
+            if (!candidates.empty()) // cheap enough to evaluate every window, and clear the excluded ones afterwards
+                apDst->rasterData.setTo(RASTER_NODATA, roi_image == 0);
+            return r;
+        }
+        // GEOTECH takes the plane from the moment table and scores the sensor points through the shared sensor footprint.
+        // Both are heading independent, falls back to the gathering engine if the sensor is not covered by the kernel
+        if (parameters.windowEngine == ENGINE_MOMENTS && filtertype == FILTER_GEOTECH)
+        {
+            auto start_ = std::chrono::high_resolution_clock::now();
+            auto apTable = getMomentTable(apSrc);
+            if (apTable == nullptr)
+            {
+                s << "Moment table of layer [" << yellow << raster << red << "] not available";
+                logc.error("p::applyWindowFilter", s);
+                return ERROR_WRONG_ARGUMENT;
+            }
+            auto apSensor = getSensorFootprint(apSrc, sx, sy);
+            const geotechStruct &sensor = parameters.geotechSensor;
+            if (computeGeotechFilter(apSrc->rasterData, srcNoData, *apTable, apKernel->bank.window, *apSensor, sx, sy, sensor.z_optimal,
+                                     sensor.z_suboptimal, apDst->rasterData, parameters.tileSize, candidates, index) == NO_ERROR)
+            {
+                std::chrono::duration<double> duration_all = std::chrono::high_resolution_clock::now() - start_;
+                if (verbosity > VERBOSITY_1)
+                {
+                    s << "Geotech moments [" << apSensor->offset.size() << " sensor px]: " << duration_all.count() << " s";
+                    logc.debug("p::applyWindowFilter", s);
+                }
+                return NO_ERROR;
+            }
+        }
+        // only the plane-fit filters accept the subsampled window (see getWindowFootprint)
+        KernelFootprint window = getWindowFootprint(apSrc, apKernel, sx, sy, {filtertype});
+        // two-tier convex slope screening: the hull slope is only evaluated for the windows whose cheap bound reaches the
+        // threshold the slope map will be compared against (see computeSlopeScreen)
+        cv::Mat pending = candidates;
+        if (!std::isnan(screenThreshold) && parameters.slopeScreening > 0 && filtertype == FILTER_CONVEX_SLOPE)
+        {
+            auto start_ = std::chrono::high_resolution_clock::now();
+            auto apTable = getMomentTable(apSrc);
+            cv::Mat screened;
+            if (apTable != nullptr && computeSlopeScreen(apSrc->rasterData, srcNoData, *apTable, window, sx, sy, filtertype, screenThreshold,
+                                                         parameters.slopeScreening, apDst->rasterData, screened, parameters.tileSize, index) == NO_ERROR)
+            {
+                if (candidates.empty())
+                    pending = screened;
+                else
+                {
+                    cv::bitwise_and(screened, candidates, pending);
+                    apDst->rasterData.setTo(RASTER_NODATA, roi_image == 0);
+                }
+            }
+            if (verbosity > VERBOSITY_1 && !screened.empty())
+            {
+                std::chrono::duration<double> duration_all = std::chrono::high_resolution_clock::now() - start_;
+                int nValid = std::max(1, cv::countNonZero(roi_image));
+                int nPending = cv::countNonZero(pending);
+                s << "Slope screening: " << nPending << " of " << nValid << " windows pending (" << 100.0 * nPending / nValid << "%), "
+                  << duration_all.count() << " s";
+                logc.debug("p::applyWindowFilter", s);
+            }
+        }
+        // CONVEX_SLOPE only needs the upper hull of the window, whose candidates are shared by consecutive windows of a row
+        if (parameters.hullSweep && filtertype == FILTER_CONVEX_SLOPE)
+        {
+            // samples below a pair of opposite neighbours are skipped, if the candidate bitmap of the source is available
+            cv::Mat upperCandidates;
+            auto it = hullCandidates.find(raster);
+            if (it != hullCandidates.end())
+            {
+                auto apCand = dynamic_pointer_cast<RasterLayer>(getLayer(it->second));
+                if (apCand != nullptr && apCand->rasterData.size() == apSrc->rasterData.size())
+                    upperCandidates = apCand->rasterData;
+            }
+            auto start_ = std::chrono::high_resolution_clock::now();
+            int r = computeConvexSweepFilter(apSrc->rasterData, srcNoData, apKernel->bank.window, sx, sy, apDst->rasterData, upperCandidates, parameters.hullSolver,
+                                             parameters.tileSize, pending, index);
+            std::chrono::duration<double> duration_all = std::chrono::high_resolution_clock::now() - start_;
+            if (verbosity > VERBOSITY_1)
+            {
+                s << "Convex hull sweep [" << (parameters.hullSolver == HULL_CGAL ? "CGAL" : "ENVELOPE") << "]: " << duration_all.count()
+                  << " s, " << 1e6 * duration_all.count() / std::max(1, cv::countNonZero(roi_image)) << " us/pixel";
+                logc.debug("p::applyWindowFilter", s);
+            }
+            return r;
+        }
+
+        auto start_ = std::chrono::high_resolution_clock::now();
+        int result = NO_ERROR;
 
-        // cv::Mat kernelMask;
+#ifndef USE_CUDA
+        // every filter runs as its own compile-time specialisation of the gathering engine (see WindowPolicy)
+        const geotechStruct &sensor = parameters.geotechSensor;
+        switch (filtertype)
+        {
+        case FILTER_MEAN:
+            result = computeWindowFilter(apSrc->rasterData, srcNoData, window, sx, sy, MeanPolicy(), apDst->rasterData, parameters.tileSize, pending, index);
+            break;
+        case FILTER_SLOPE:
+            result = computeWindowFilter(apSrc->rasterData, srcNoData, window, sx, sy, SlopePolicy(), apDst->rasterData, parameters.tileSize, pending, index);
+            break;
+        case FILTER_CONVEX_SLOPE:
+            result = computeWindowFilter(apSrc->rasterData, srcNoData, window, sx, sy, ConvexSlopePolicy(parameters.hullSolver), apDst->rasterData, parameters.tileSize,
+                                         pending, index);
+            break;
+        case FILTER_DISTANCE:
+            result = computeWindowFilter(apSrc->rasterData, srcNoData, window, sx, sy,
+                                         DistancePolicy(sensor.z_optimal, sensor.z_suboptimal), apDst->rasterData, parameters.tileSize, pending, index);
+            break;
+        case FILTER_GEOTECH:
+        {
+            // the sensor points are scored at full resolution through the shared sensor footprint, when the window covers it
+            auto apSensor = getSensorFootprint(apSrc, sx, sy);
+            const SensorFootprint *sensorFootprint = apSensor->isCoveredBy(apKernel->bank.window) ? apSensor.get() : nullptr;
+            result = computeWindowFilter(apSrc->rasterData, srcNoData, window, sx, sy,
+                                         GeotechPolicy(sensor.diameter, sensor.z_optimal, sensor.z_suboptimal, sensorFootprint, &apSrc->rasterData, srcNoData),
+                                         apDst->rasterData, parameters.tileSize, pending, index);
+            break;
+        }
+        case FILTER_TRI:
+            result = computeWindowFilter(apSrc->rasterData, srcNoData, window, sx, sy, TriPolicy(), apDst->rasterData, parameters.tileSize, pending, index);
+            break;
+        case FILTER_TPI:
+            result = computeWindowFilter(apSrc->rasterData, srcNoData, window, sx, sy, TpiPolicy(), apDst->rasterData, parameters.tileSize, pending, index);
+            break;
+        case FILTER_ROUGHNESS:
+            result = computeWindowFilter(apSrc->rasterData, srcNoData, window, sx, sy, RoughnessPolicy(), apDst->rasterData, parameters.tileSize, pending, index);
+            break;
+        case FILTER_CURVATURE:
+            result = computeWindowFilter(apSrc->rasterData, srcNoData, window, sx, sy, CurvaturePolicy(), apDst->rasterData, parameters.tileSize, pending, index);
+            break;
+        default:
+            s << "Filter type [" << filtertype << "] not supported";
+            logc.error("p::applyWindowFilter", s);
+            return ERROR_WRONG_ARGUMENT;
+        }
+#else
+        // the CUDA build masks every window on the GPU, and reduces it in place
+        int hKernel_2 = hKernel >> 1;
+        int wKernel_2 = wKernel >> 1;
         cv::Mat kernelMaskBin;
-        // apKernel->rotatedData.convertTo(kernelMask, CV_64FC1);
         apKernel->rotatedData.convertTo(kernelMaskBin, CV_8UC1);
-
-#ifdef USE_CUDA
         cv::cuda::GpuMat kernelMaskBin_gpu;
         cv::cuda::GpuMat roi_image_gpu;
         // before trying to port to GPU, please check that the image size iw worth it. The bottleneck in our
         // case is the CPU-GPU memory bandwith, so no speed-up is possible for small sized images
         roi_image_gpu.upload(roi_image);
         kernelMaskBin_gpu.upload(kernelMaskBin);
-#endif
 
         lad::tictac timer;
         timer.start();
         double acum_timer_mp = 0;
         double acum_timer_process = 0;
 
-        auto start_ = std::chrono::high_resolution_clock::now();
-
 #pragma omp parallel for schedule(dynamic)
         for (int row = 0; row < nRows; row++)
         {
@@ -1647,7 +1902,7 @@ namespace lad
 
             uchar *row_ptr = roi_image.ptr<uchar>(row); // retrieve index to row
 
-#pragma omp parallel for schedule(dynamic)
+            // a single team over rows: a nested team per row would oversubscribe the heading level threads
             for (int col = 0; col < nCols; col++)
             {
                 if (row_ptr[col])
@@ -1659,13 +1914,13 @@ namespace lad
                         cl = 0;
                     int cr = col + wKernel_2;
                     if (cr > nCols)
-                        cr = nCols - 1;
+                        cr = nCols; // exclusive range end, the last column must be kept
                     int rt = row - hKernel_2;
                     if (rt < 0)
                         rt = 0;
                     int rb = row + hKernel_2;
                     if (rb > nRows)
-                        rb = nRows - 1;
+                        rb = nRows; // exclusive range end, the last row must be kept
 
                     // CGAL_PROFILER("Effective iter of applyWindowFilter inner for-loop");
 
@@ -1678,33 +1933,22 @@ namespace lad
                     double acum = 0;
                     int r;
 
-                    std::vector<KPoint> pointList;
-                    pointList.reserve(0.5 * nCols * nRows); // experimental: we have some good estimation of necessary space
-                    std::vector<KPoint> pointListReduced;   // vector containing points inside the sensor footprint
-                    pointListReduced.reserve(2000);
+                    // per-thread reusable buffers, no heap allocation once they reached the kernel size
+                    WindowScratch &scratch = getWindowScratch();
+                    scratch.reset(hKernel * wKernel);
+                    std::vector<KPoint> &pointList = scratch.points;
+                    std::vector<KPoint> &pointListReduced = scratch.sensor; // vector containing points inside the sensor footprint
 
-                    cv::Mat temp, mask;
                     cv::Mat subImage = apSrc->rasterData(cv::Range(rt, rb), cv::Range(cl, cr)); // 64FC1
-
-#ifdef USE_CUDA
+                    cv::Mat temp, mask;
                     cv::cuda::GpuMat subMask_gpu = kernelMaskBin_gpu(cv::Range(yi, yf), cv::Range(xi, xf)); // 8UC1 subImage contains the raw data patch
                     cv::cuda::GpuMat roi_patch_gpu = roi_image_gpu(cv::Range(rt, rb), cv::Range(cl, cr));   // 8UC1 apKernel contains and additional mask
                     cv::cuda::GpuMat mask_gpu;
                     cv::cuda::bitwise_and(subMask_gpu, roi_patch_gpu, mask_gpu);
                     mask_gpu.download(mask);
-
-#else
-                    cv::Mat subMask = kernelMaskBin(cv::Range(yi, yf), cv::Range(xi, xf)); // 8UC1 subImage contains the raw data patch
-                    cv::Mat roi_patch = roi_image(cv::Range(rt, rb), cv::Range(cl, cr));   // 8UC1 apKernel contains and additional mask
-                    // cv::Mat subImage  = apSrc->rasterData(cv::Range(rt, rb), cv::Range(cl, cr)); //64FC1
-                    cv::bitwise_and(subMask, roi_patch, mask);
-#endif
-
                     subImage.copyTo(temp, mask);
                     r = convertMatrix2Vector_Points(temp, sx, sy, pointList, &acum, pointListReduced, parameters.geotechSensor.diameter); //
 
-                    // r = convertMatrix2Vector_Masked  (subImage, roi_patch, subMask, sx, sy, pointList, &acum, pointListReduced, parameters.geotechSensor.diameter); //
-
                     // WARNING: as we need a minimum set of valid 3D points for the plane fitting
                     // we filter using the size of pointList. For a 3x3 kernel matrix, the min number of points
                     // is n > K/2, being K = 3x3 = 9 ---> n = 5
@@ -1717,7 +1961,7 @@ namespace lad
 
                             KPlane plane = computeFittingPlane(pointList);             //< 8 seconds for sparse, 32 seconds for dense maps
                             double slope = computePlaneSlope(plane, KVector(0, 0, 1)); // returned value is the angle of the normal to the plane, in radians
-                            apDst->rasterData.at<double>(row, col) = slope;
+                            apDst->rasterData.at<raster_t>(row, col) = slope;
                         }
                         else if (filtertype == FILTER_CONVEX_SLOPE)
                         {
@@ -1727,14 +1971,14 @@ namespace lad
                             {
                                 _p = _p - _zmean;
                             }
-                            KPlane plane = computeConvexHullPlane(pointList); //< 8 seconds for sparse, 32 seconds for dense maps
+                            KPlane plane = computeConvexHullPlane(pointList, parameters.hullSolver); //< CGAL convex_hull_3, or the upper envelope solver (hull_solver)
                             // KPlane plane = computeFittingPlane(pointList); //< 8 seconds for sparse, 32 seconds for dense maps
                             double slope = computePlaneSlope(plane, KVector(0, 0, 1)); // returned value is the angle of the normal to the plane, in radians
-                            apDst->rasterData.at<double>(row, col) = slope;
+                            apDst->rasterData.at<raster_t>(row, col) = slope;
                         }
                         else if (filtertype == FILTER_MEAN)
                         {
-                            apDst->rasterData.at<double>(row, col) = _mean;
+                            apDst->rasterData.at<raster_t>(row, col) = _mean;
                         }
                         else if (filtertype == FILTER_GEOTECH)
                         {                                                  // reduce to points contained inside a given diameter (geotech sensor)
@@ -1743,7 +1987,8 @@ namespace lad
                             double score = 0;
                             if (r)
                             { // if no point was captured, we report "ZERO" as total measurability
-                                std::vector<double> distances = computePlaneDistance(plane, pointListReduced);
+                                std::vector<double> &distances = scratch.distances;
+                                computePlaneDistance(plane, pointListReduced, distances);
 
                                 for (auto it : distances)
                                 {
@@ -1756,21 +2001,8 @@ namespace lad
                                         score += 1 / (1 + (zit - parameters.geotechSensor.z_optimal) / parameters.geotechSensor.z_suboptimal);
                                 }
                             }
-#pragma omp critical
-                            {
-                                try
-                                {
-                                    apDst->rasterData.at<double>(row, col) = score / pointListReduced.size();
-                                }
-                                catch (const std::exception &e)
-                                {
-                                    std::cerr << e.what() << '\n';
-                                    s << "Pixel [" << col << "," << row << "]" << red << "\tpoints: " << pointListReduced.size() << green << "\tAcum: " << score;
-                                    logc.debug("filter-debug", s);
-                                    s << "rasterData cvMat size: " << cyan << apDst->rasterData.size();
-                                    logc.debug("filter-debug", s);
-                                }
-                            }
+                            // every pixel is written by a single thread, no synchronization is required
+                            apDst->rasterData.at<raster_t>(row, col) = r ? score / r : 0;
                         }
                         // TODO: Measurability filter (FILTER_DISTANCE) should rather use the effective calculated plane, either mean or convex hull one
                         else if (filtertype == FILTER_DISTANCE)
@@ -1778,7 +2010,8 @@ namespace lad
                             KPlane plane = computeFittingPlane(pointList); //< 8 seconds
                             // TODO: RECYCLE THE PRECOMUTED PLANES! THE POINTlIST INPUT IS THE SAME AS IN LANE A (just once, because it was rotation invariant)
                             // KPlane plane = computeConvexHullPlane(pointList); //< 8 seconds for sparse, 32 seconds for dense maps
-                            std::vector<double> distances = computePlaneDistance(plane, pointList);
+                            std::vector<double> &distances = scratch.distances;
+                            computePlaneDistance(plane, pointList, distances);
                             double score = 0;
                             for (auto it : distances)
                             {
@@ -1788,28 +2021,14 @@ namespace lad
                                 else
                                     score += 1 / (1 + (zit - parameters.geotechSensor.z_optimal) / parameters.geotechSensor.z_suboptimal);
                             }
-// computes aggregated measurability score per pixel
-#pragma omp critical
-                            {
-                                try
-                                {
-                                    apDst->rasterData.at<double>(row, col) = score / pointList.size();
-                                }
-                                catch (const std::exception &e)
-                                {
-                                    std::cerr << e.what() << '\n';
-                                    s << "Pixel [" << col << "," << row << "]" << red << "\tpoints: " << pointList.size() << green << "\tAcum: " << score;
-                                    logc.debug("filter-debug", s);
-                                    s << "rasterData cvMat size: " << cyan << apDst->rasterData.size();
-                                    logc.debug("filter-debug", s);
-                                }
-                            }
+                            // computes aggregated measurability score per pixel
+                            apDst->rasterData.at<raster_t>(row, col) = score / pointList.size();
                         }
                     }
                     else
                     { // we do not have enough points to compute a valid plane
-                        apDst->rasterData.at<double>(row, col) = DEFAULT_NODATA_VALUE;
-                        // apDst->rasterData.at<double>(cv::Point(col, row)) = DEFAULT_NODATA_VALUE;
+                        apDst->rasterData.at<raster_t>(row, col) = RASTER_NODATA;
+                        // apDst->rasterData.at<raster_t>(cv::Point(col, row)) = DEFAULT_NODATA_VALUE;
                     } //*/
 
                     // stop_map = std::chrono::high_resolution_clock::now();
@@ -1817,14 +2036,24 @@ namespace lad
                     // acum_timer_process = acum_timer_process + duration.count();
                 }
                 else
-                    apDst->rasterData.at<double>(row, col) = DEFAULT_NODATA_VALUE;
-                // apDst->rasterData.at<double>(cv::Point(col, row)) = DEFAULT_NODATA_VALUE;
+                    apDst->rasterData.at<raster_t>(row, col) = RASTER_NODATA;
+                // apDst->rasterData.at<raster_t>(cv::Point(col, row)) = DEFAULT_NODATA_VALUE;
             }
         }
 
+#endif
+        if (!candidates.empty()) // the CUDA path evaluates every window
+            apDst->rasterData.setTo(RASTER_NODATA, roi_image == 0);
+
         auto stop_ = std::chrono::high_resolution_clock::now();
         std::chrono::duration<double> duration_all = stop_ - start_;
         // acum_timer_mp = acum_timer_mp + duration_all.count();
+        if (verbosity > VERBOSITY_1)
+        {
+            s << "Window filter [" << filtertype << "]: " << duration_all.count() << " s, "
+              << 1e6 * duration_all.count() / std::max(1, cv::countNonZero(roi_image)) << " us/pixel";
+            logc.debug("p::applyWindowFilter", s);
+        }
 
         //        s << " ----------------------------------------------------------------- Ellapsed: " << yellow << duration_all.count() << reset;
         //        logc.debug("\t>> combined loop", s);
@@ -1834,6 +2063,398 @@ namespace lad
         // cout << "Block B1 - conv:\t" << acumB1 << endl;
         // cout << "Block C - fit:\t" << acumC << endl;
 
+        return result;
+    }
+
+    /**
+     * @brief Heading-batched windowed filter. Evaluates the same filter for a list of (rotated) kernels in a single pass
+     * over the raster, storing the result of each kernel straight into its own single-channel layer. Only FILTER_SLOPE and
+     * FILTER_MEAN are supported, as the batch relies on the moment engine (see lad_window.hpp)
+     *
+     * @param raster Source layer to be filtered
+     * @param kernels List of sliding kernels, typically the rotated copies of the vehicle footprint
+     * @param mask Global raster mask that can be used as ROI
+     * @param dst List of destination layer names, one per kernel. They are created if not present
+     * @param filtertype type of filter to be applied: mean or slope
+     * @return int Error code, if any
+     */
+    int Pipeline::applyWindowFilter(std::string raster, std::vector<std::string> kernels, std::string mask, std::vector<std::string> dst, int filtertype)
+    {
+        ostringstream s;
+        if (filtertype != FILTER_SLOPE && filtertype != FILTER_MEAN)
+        {
+            s << "Filter type [" << filtertype << "] not supported in batched mode";
+            logc.error("p::applyWindowFilter", s);
+            return ERROR_WRONG_ARGUMENT;
+        }
+        if (kernels.empty() || kernels.size() != dst.size())
+        {
+            s << "Invalid batch: " << kernels.size() << " kernels for " << dst.size() << " destination layers";
+            logc.error("p::applyWindowFilter", s);
+            return ERROR_WRONG_ARGUMENT;
+        }
+        auto apSrc = dynamic_pointer_cast<RasterLayer>(getLayer(raster));
+        if (apSrc == nullptr)
+        {
+            s << "Base bathymetry Layer [" << yellow << raster << red << "] not found...";
+            logc.error("p::applyWindowFilter", s);
+            return LAYER_NOT_FOUND;
+        }
+        auto apMask = dynamic_pointer_cast<RasterLayer>(getLayer(mask));
+        if (apMask == nullptr)
+        {
+            s << "Base valid mask Layer [" << yellow << mask << red << "] not found...";
+            logc.error("p::applyWindowFilter", s);
+            return LAYER_NOT_FOUND;
+        }
+
+        // every kernel contributes its window footprint, trimmed to the same window used by applyWindowFilter
+        std::vector<KernelFootprint> footprints(kernels.size());
+        std::vector<std::shared_ptr<RasterLayer>> apDst(kernels.size());
+        for (int k = 0; k < kernels.size(); k++)
+        {
+            auto apKernel = dynamic_pointer_cast<KernelLayer>(getLayer(kernels[k]));
+            if (apKernel == nullptr)
+            {
+                s << "Kernel layer [" << yellow << kernels[k] << red << "] not found...";
+                logc.error("p::applyWindowFilter", s);
+                return LAYER_NOT_FOUND;
+            }
+            footprints[k] = apKernel->bank.window;
+
+            apDst[k] = dynamic_pointer_cast<RasterLayer>(getLayer(dst[k]));
+            if (apDst[k] == nullptr)
+            {
+                createLayer(dst[k], LAYER_RASTER);
+                apDst[k] = dynamic_pointer_cast<RasterLayer>(getLayer(dst[k]));
+                if (apDst[k] == nullptr)
+                {
+                    s << "could not create <RasterLayer>: " << dst[k];
+                    logc.error("p::applyWindowFilter", s);
+                    return LAYER_NOT_FOUND;
+                }
+            }
+            apDst[k]->setNoDataValue(RASTER_NODATA);
+            apDst[k]->copyGeoProperties(apSrc);
+            apDst[k]->setMask(apSrc->getMask());
+        }
+
+        if (verbosity > VERBOSITY_0)
+        {
+            s << "Batched filter over [" << kernels.size() << "] kernels, input raster size: " << apSrc->rasterData.size();
+            logc.debug("p::applyWindowFilter", s);
+        }
+        double sx = geoTransform[1];
+        double sy = geoTransform[5];
+        // the outputs are written in place, no intermediate multi-channel copy of the whole sweep is kept
+        std::vector<cv::Mat> dstData(kernels.size());
+        for (int k = 0; k < kernels.size(); k++)
+            dstData[k] = apDst[k]->rasterData;
+        auto apIndex = getValidIndex(apSrc);
+        int r = computeMomentFilter(apSrc->rasterData, apSrc->getNoDataValue(), *getMomentTable(apSrc), footprints, sx, sy, filtertype, dstData,
+                                    parameters.tileSize, apIndex.get());
+        // windows outside the ROI mask stay NODATA, as in the single kernel filter
+        cv::Mat candidates = getCandidateMask(apSrc, apMask);
+        for (int k = 0; k < kernels.size(); k++)
+        {
+            apDst[k]->rasterData = dstData[k];
+            if (!candidates.empty())
+                apDst[k]->rasterData.setTo(RASTER_NODATA, candidates == 0);
+        }
+        return r;
+    }
+
+    /**
+     * @brief Fused windowed filter. Evaluates several filters for the same kernel in a single pass over the raster: the
+     * points of every window are gathered and fitted just once, and every requested output is derived from the same
+     * plane. Supported filters are every FilterType but FILTER_CONVEX_SLOPE, which does not use the fitting plane (terrain
+     * descriptors TRI, TPI, ROUGHNESS and CURVATURE share the gathered points). If the plane coefficients of (raster, kernel) are available (see computePlaneLayer), they replace the
+     * fitting, and FILTER_SLOPE does not even gather the points
+     *
+     * @param raster Source layer to be filtered
+     * @param kernel Sliding kernel, typically a binary structuring element
+     * @param mask Global raster mask that can be used as ROI
+     * @param outputs Map of filter type -> name of the layer that will store its resulting image
+     * @return int Error code, if any
+     */
+    int Pipeline::applyWindowFilter(std::string raster, std::string kernel, std::string mask, std::map<int, std::string> outputs)
+    {
+        ostringstream s;
+        if (outputs.empty())
+        {
+            logc.error("p::applyWindowFilter", "No output was requested for the fused filter");
+            return ERROR_MISSING_ARGUMENT;
+        }
+        for (auto &o : outputs)
+        {
+            if (o.first < FILTER_MEAN || o.first > FILTER_CURVATURE || o.first == FILTER_CONVEX_SLOPE)
+            {
+                s << "Filter type [" << o.first << "] not supported in fused mode";
+                logc.error("p::applyWindowFilter", s);
+                return ERROR_WRONG_ARGUMENT;
+            }
+        }
+        auto apSrc = dynamic_pointer_cast<RasterLayer>(getLayer(raster));
+        if (apSrc == nullptr)
+        {
+            s << "Base bathymetry Layer [" << yellow << raster << red << "] not found...";
+            logc.error("p::applyWindowFilter", s);
+            return LAYER_NOT_FOUND;
+        }
+        auto apMask = dynamic_pointer_cast<RasterLayer>(getLayer(mask));
+        if (apMask == nullptr)
+        {
+            s << "Base valid mask Layer [" << yellow << mask << red << "] not found...";
+            logc.error("p::applyWindowFilter", s);
+            return LAYER_NOT_FOUND;
+        }
+        auto apKernel = dynamic_pointer_cast<KernelLayer>(getLayer(kernel));
+        if (apKernel == nullptr)
+        {
+            s << "Kernel layer [" << yellow << kernel << red << "] not found...";
+            logc.error("p::applyWindowFilter", s);
+            return LAYER_NOT_FOUND;
+        }
+
+        // plane coefficients of a previous pass (or run) with the same kernel, unless they are being recomputed
+        cv::Mat planeData;
+        if (outputs.find(FILTER_PLANE) == outputs.end())
+            planeData = getPlaneData(raster, kernel);
+        bool usePlanes = !planeData.empty();
+
+        // one destination container per requested filter, indexed by filter type. Empty containers are not computed
+        cv::Mat dstData[FILTER_CURVATURE + 1];
+        for (auto &o : outputs)
+        {
+            auto apDst = dynamic_pointer_cast<RasterLayer>(getLayer(o.second));
+            if (apDst == nullptr)
+            {
+                createLayer(o.second, LAYER_RASTER);
+                apDst = dynamic_pointer_cast<RasterLayer>(getLayer(o.second));
+                if (apDst == nullptr)
+                {
+                    s << "could not create <RasterLayer>: " << o.second;
+                    logc.error("p::applyWindowFilter", s);
+                    return LAYER_NOT_FOUND;
+                }
+            }
+            // plane layers hold PLANE_LAYER_BANDS channels in double precision (whatever RASTER_TYPE is), filled with the
+            // NODATA sentinel whatever RASTER_NODATA is, as their point count is tested against a minimum (cv::Scalar is
+            // limited to 4 channels)
+            if (o.first == FILTER_PLANE)
+            {
+                apDst->rasterData = cv::Mat(apSrc->rasterData.rows, apSrc->rasterData.cols * PLANE_LAYER_BANDS, CV_64FC1, DEFAULT_NODATA_VALUE).reshape(PLANE_LAYER_BANDS);
+                apDst->setNoDataValue(DEFAULT_NODATA_VALUE);
+            }
+            else
+            {
+                apDst->rasterData = cv::Mat(apSrc->rasterData.size(), RASTER_TYPE, RASTER_NODATA);
+                apDst->setNoDataValue(RASTER_NODATA);
+            }
+            apDst->copyGeoProperties(apSrc);
+            apDst->setMask(apSrc->getMask());
+            dstData[o.first] = apDst->rasterData; // shares the buffer of the layer
+        }
+
+        double srcNoData = apSrc->getNoDataValue();
+        int nRows = apSrc->rasterData.rows;
+        int nCols = apSrc->rasterData.cols;
+        int nPixels = apKernel->rotatedData.rows * apKernel->rotatedData.cols;
+        double sx = geoTransform[1];
+        double sy = geoTransform[5];
+
+        // windows outside the ROI mask are not evaluated. Plane layers are reused as a cache by
+        // later runs (with other exclusions), so they are always complete
+        cv::Mat candidates = dstData[FILTER_PLANE].empty() ? getCandidateMask(apSrc, apMask) : cv::Mat();
+        auto apIndex = getValidIndex(apSrc);
+
+        // MEAN and SLOPE are cheaper from the moment tables, which do not need the gathered points
+        if (parameters.windowEngine == ENGINE_MOMENTS)
+        {
+            for (int f : {FILTER_MEAN, FILTER_SLOPE})
+            {
+                if (dstData[f].empty() || (f == FILTER_SLOPE && usePlanes))
+                    continue;
+                computeMomentFilter(apSrc->rasterData, srcNoData, *getMomentTable(apSrc), apKernel->bank.window, sx, sy, f, dstData[f], parameters.tileSize,
+                                    apIndex.get());
+                if (!candidates.empty())
+                    dstData[f].setTo(RASTER_NODATA, candidates == 0);
+                dstData[f] = cv::Mat();
+            }
+        }
+        bool needDistance = !dstData[FILTER_DISTANCE].empty() || !dstData[FILTER_RESIDUAL].empty();
+        bool needPlane = needDistance || !dstData[FILTER_SLOPE].empty() || !dstData[FILTER_GEOTECH].empty() || !dstData[FILTER_PLANE].empty();
+        // with precomputed planes, the slope is evaluated straight from the coefficients
+        bool needDescriptors = !dstData[FILTER_TRI].empty() || !dstData[FILTER_TPI].empty() || !dstData[FILTER_ROUGHNESS].empty();
+        bool needPoints = needDistance || needDescriptors || !dstData[FILTER_MEAN].empty() || !dstData[FILTER_GEOTECH].empty() ||
+                          !dstData[FILTER_PLANE].empty() || !dstData[FILTER_CURVATURE].empty() || (!dstData[FILTER_SLOPE].empty() && !usePlanes);
+        if (!needPlane && !needPoints)
+            return NO_ERROR;
+
+        // the outputs still pending decide whether the window can be subsampled (see getWindowFootprint). The slope is read
+        // from the stored planes if they are available
+        std::vector<int> gathered;
+        for (int f = 0; f <= FILTER_CURVATURE; f++)
+            if (!dstData[f].empty() && !(f == FILTER_SLOPE && usePlanes))
+                gathered.push_back(f);
+        KernelFootprint footprint = getWindowFootprint(apSrc, apKernel, sx, sy, gathered);
+        footprint.setStride(apSrc->rasterData.step1(), getRasterHalo(apSrc->rasterData));
+
+        cv::Mat roi_image = apIndex->mask; // shared with the index, read-only
+        if (!candidates.empty())
+            cv::bitwise_and(apIndex->mask, candidates, roi_image);
+
+        const geotechStruct &sensor = parameters.geotechSensor;
+        // the sensor points are read at full resolution through the shared (heading independent) sensor offsets instead of
+        // being gathered for every window, when the sensor lies inside the complete window footprint
+        std::shared_ptr<SensorFootprint> apSensor;
+        if (!dstData[FILTER_GEOTECH].empty())
+            apSensor = getSensorFootprint(apSrc, sx, sy);
+        bool sensorOffsets = apSensor != nullptr && apSensor->isCoveredBy(apKernel->bank.window);
+        double gatherDiameter = sensorOffsets ? 0 : sensor.diameter;
+        auto measurability = [&sensor](double d) -> double
+        {
+            double zit = fabs(d);
+            if (zit < sensor.z_optimal)
+                return 1.0;
+            return 1 / (1 + (zit - sensor.z_optimal) / sensor.z_suboptimal);
+        };
+
+        auto start_ = std::chrono::high_resolution_clock::now();
+
+        std::vector<WindowTile> tiles;
+        apIndex->planTiles(parameters.tileSize, footprint.bbox, tiles);
+        forEachWindowTile(tiles, [&](const WindowTile &tile)
+        {
+            WindowScratch &scratch = getWindowScratch();
+            for (int row = tile.row0; row < tile.row1; row++)
+            {
+                const uchar *row_ptr = roi_image.ptr<uchar>(row);
+                // row pointers of the requested outputs, nullptr if not requested
+                raster_t *meanRow = dstData[FILTER_MEAN].empty() ? nullptr : dstData[FILTER_MEAN].ptr<raster_t>(row);
+                raster_t *slopeRow = dstData[FILTER_SLOPE].empty() ? nullptr : dstData[FILTER_SLOPE].ptr<raster_t>(row);
+                raster_t *distanceRow = dstData[FILTER_DISTANCE].empty() ? nullptr : dstData[FILTER_DISTANCE].ptr<raster_t>(row);
+                raster_t *geotechRow = dstData[FILTER_GEOTECH].empty() ? nullptr : dstData[FILTER_GEOTECH].ptr<raster_t>(row);
+                raster_t *residualRow = dstData[FILTER_RESIDUAL].empty() ? nullptr : dstData[FILTER_RESIDUAL].ptr<raster_t>(row);
+                double *planeRow = dstData[FILTER_PLANE].empty() ? nullptr : dstData[FILTER_PLANE].ptr<double>(row);
+                raster_t *triRow = dstData[FILTER_TRI].empty() ? nullptr : dstData[FILTER_TRI].ptr<raster_t>(row);
+                raster_t *tpiRow = dstData[FILTER_TPI].empty() ? nullptr : dstData[FILTER_TPI].ptr<raster_t>(row);
+                raster_t *roughnessRow = dstData[FILTER_ROUGHNESS].empty() ? nullptr : dstData[FILTER_ROUGHNESS].ptr<raster_t>(row);
+                raster_t *curvatureRow = dstData[FILTER_CURVATURE].empty() ? nullptr : dstData[FILTER_CURVATURE].ptr<raster_t>(row);
+                const raster_t *srcRow = apSrc->rasterData.ptr<raster_t>(row);
+                const double *cachedRow = usePlanes ? planeData.ptr<double>(row) : nullptr;
+
+                for (int col = tile.col0; col < tile.col1; col++)
+                {
+                    if (!row_ptr[col])
+                        continue; // containers were initialized to NODATA
+                    KPlane plane;
+                    if (usePlanes)
+                    {
+                        const double *pl = cachedRow + PLANE_LAYER_BANDS * col;
+                        if (pl[4] <= 5) // not enough points for a valid plane (or NODATA)
+                            continue;
+                        plane = KPlane(pl[0], pl[1], pl[2], pl[3]);
+                        if (slopeRow)
+                            slopeRow[col] = computePlaneSlope(plane, KVector(0, 0, 1));
+                        if (!needPoints)
+                            continue;
+                    }
+                    // same window extent and coordinate origin (the anchor) as the single filter version
+                    double acum = 0;
+                    scratch.reset(nPixels);
+                    std::vector<KPoint> &pointList = scratch.points;
+                    int r = gatherFootprintPoints(apSrc->rasterData, srcNoData, row, col, footprint, nRows, nCols, row, col, sx, sy,
+                                                  pointList, &acum, scratch.sensor, gatherDiameter);
+                    int n = pointList.size();
+                    if (n <= 5) // not enough points for a valid plane
+                        continue;
+                    if (meanRow)
+                        meanRow[col] = acum / n;
+                    if (needDescriptors)
+                    {
+                        double tri, tpi, roughness;
+                        lad::computeTerrainDescriptors(pointList, srcRow[col], &tri, &tpi, &roughness);
+                        if (triRow)
+                            triRow[col] = tri;
+                        if (tpiRow)
+                            tpiRow[col] = tpi;
+                        if (roughnessRow)
+                            roughnessRow[col] = roughness;
+                    }
+                    if (curvatureRow)
+                    {
+                        double q[6];
+                        if (computeFittingQuadric(pointList, q) == NO_ERROR)
+                            curvatureRow[col] = 2 * (q[0] + q[1]);
+                    }
+                    if (!needPlane)
+                        continue;
+
+                    if (!usePlanes)
+                    {
+                        plane = computeFittingPlane(pointList);
+                        if (slopeRow)
+                            slopeRow[col] = computePlaneSlope(plane, KVector(0, 0, 1));
+                        if (planeRow)
+                        {
+                            double *pl = planeRow + PLANE_LAYER_BANDS * col;
+                            pl[0] = plane.a();
+                            pl[1] = plane.b();
+                            pl[2] = plane.c();
+                            pl[3] = plane.d();
+                            pl[4] = n;
+                        }
+                    }
+                    if (needDistance)
+                    {
+                        computePlaneDistance(plane, pointList, scratch.distances);
+                        double score = 0, sq = 0;
+                        for (auto d : scratch.distances)
+                        {
+                            score += measurability(d);
+                            sq += d * d;
+                        }
+                        if (distanceRow)
+                            distanceRow[col] = score / n;
+                        if (residualRow)
+                            residualRow[col] = sqrt(sq / n);
+                    }
+                    if (geotechRow && sensorOffsets)
+                    {
+                        double pl[4] = {plane.a(), plane.b(), plane.c(), plane.d()};
+                        geotechRow[col] = computeSensorScore(apSrc->rasterData, srcNoData, row, col, *apSensor, pl, sensor.z_optimal, sensor.z_suboptimal);
+                    }
+                    else if (geotechRow)
+                    {
+                        double score = 0;
+                        if (r) // if no point was captured, we report "ZERO" as total measurability
+                        {
+                            computePlaneDistance(plane, scratch.sensor, scratch.distances);
+                            for (auto d : scratch.distances)
+                                score += measurability(d);
+                            score /= r;
+                        }
+                        geotechRow[col] = score;
+                    }
+                }
+            }
+        });
+
+        std::chrono::duration<double> duration_all = std::chrono::high_resolution_clock::now() - start_;
+        if (verbosity > VERBOSITY_1)
+        {
+            s << "Fused window filter [" << outputs.size() << " outputs" << (usePlanes ? ", cached planes" : "") << "]: " << duration_all.count() << " s, "
+              << 1e6 * duration_all.count() / std::max(1, cv::countNonZero(roi_image)) << " us/pixel";
+            logc.debug("p::applyWindowFilter", s);
+        }
+        // the new plane coefficients are reused by any later filter of the same (raster, kernel)
+        auto itPlane = outputs.find(FILTER_PLANE);
+        if (itPlane != outputs.end())
+        {
+#pragma omp critical(planeLayers)
+            planeLayers[std::make_pair(raster, kernel)] = itPlane->second;
+        }
         return NO_ERROR;
     }
 
@@ -1851,7 +2472,31 @@ namespace lad
         {
             logc.debug("computeMeanSlopeMap", "Calling applyWindowFilter");
         }
-        return applyWindowFilter(raster, kernel, mask, dst, FILTER_SLOPE);
+        int r = applyWindowFilter(raster, kernel, mask, dst, FILTER_SLOPE);
+#ifdef USE_FLOAT32
+        if (r == NO_ERROR)
+            reportSlopePrecision(raster, kernel, dst);
+#endif
+        return r;
+    }
+
+    /**
+     * @brief Compute a slope map (least-squares or convex hull) that will be compared against a threshold. With
+     * parameters.slopeScreening enabled, the convex hull slope is evaluated only for the windows whose cheap bound
+     * reaches the threshold, and the rest of the windows hold their upper bound. Comparing the map against the threshold
+     * gives the same binary map as computeConvexSlopeMap. The least-squares slope is always exact
+     *
+     * @param raster Bathymetry Layer interpreted as a 2.5D map
+     * @param kernel Binary mask Layer that is used to determine the subset S of points to be used for plane calculation
+     * @param mask Global raster mask that can be used as ROI
+     * @param dst Resulting raster Layer containing the (screened) slope field
+     * @param filtertype Slope algorithm (FILTER_SLOPE | FILTER_CONVEX_SLOPE), only the latter is screened
+     * @param threshold Slope threshold [deg] the map will be compared against
+     * @return int Error code, if any
+     */
+    int Pipeline::computeScreenedSlopeMap(std::string raster, std::string kernel, std::string mask, std::string dst, int filtertype, double threshold)
+    {
+        return applyWindowFilter(raster, kernel, mask, dst, filtertype, threshold);
     }
 
     /**
@@ -1889,6 +2534,477 @@ namespace lad
         // return applyWindowFilter(raster, kernel, mask, dst, FILTER_DISTANCE);
     }
 
+    /**
+     * @brief Compute the mean slope map and the measurability map in a single fused pass. Both maps share the points and
+     * the least-square fitting plane of every window, so they cost roughly the same as a single computeMeasurabilityMap
+     *
+     * @param raster Bathymetry Layer interpreted as a 2.5D map, where depth is defined for every pixel as Z = f(X,Y)
+     * @param kernel Binary mask Layer that is used to determine the subset S of points to be used for plane calculation
+     * @param mask Global raster mask that can be used as ROI
+     * @param slope Resulting raster Layer containing the slope field (as computeMeanSlopeMap)
+     * @param measurability Resulting raster Layer containing the measurability field (as computeMeasurabilityMap)
+     * @param plane Optional raster Layer that will contain the plane coefficients computed in the same pass (see computePlaneLayer)
+     * @return int Error code, if any
+     */
+    int Pipeline::computeSlopeMeasurabilityMap(std::string raster, std::string kernel, std::string mask, std::string slope, std::string measurability, std::string plane)
+    {
+        if (verbosity > VERBOSITY_0)
+        {
+            logc.debug("computeSlopeMeasurabilityMap", "Calling fused applyWindowFilter");
+        }
+        std::map<int, std::string> outputs{{FILTER_SLOPE, slope}, {FILTER_GEOTECH, measurability}};
+        if (!plane.empty())
+            outputs[FILTER_PLANE] = plane;
+        int r = applyWindowFilter(raster, kernel, mask, outputs);
+#ifdef USE_FLOAT32
+        if (r == NO_ERROR)
+            reportSlopePrecision(raster, kernel, slope);
+#endif
+        return r;
+    }
+
+    /**
+     * @brief Compute the terrain descriptor maps of a raster from a single fused pass: T1_Slope, T2_TRI, T3_TPI,
+     * T4_Roughness and T5_Curvature. They extend the gdaldem derivatives (slope, TRI, TPI, roughness) to the footprint of
+     * any kernel, e.g. the vehicle footprint or a kernel of a given metric size
+     *
+     * @param raster Bathymetry Layer interpreted as a 2.5D map, where depth is defined for every pixel as Z = f(X,Y)
+     * @param kernel Binary mask Layer that defines the window of every descriptor
+     * @param mask Global raster mask that can be used as ROI
+     * @param suffix String appended to the name of the resulting layers
+     * @return int Error code, if any
+     */
+    int Pipeline::computeTerrainDescriptorMaps(std::string raster, std::string kernel, std::string mask, std::string suffix)
+    {
+        if (verbosity > VERBOSITY_0)
+        {
+            logc.debug("computeTerrainDescriptorMaps", "Calling fused applyWindowFilter");
+        }
+        return applyWindowFilter(raster, kernel, mask, std::map<int, std::string>{{FILTER_SLOPE, "T1_Slope" + suffix}, {FILTER_TRI, "T2_TRI" + suffix}, {FILTER_TPI, "T3_TPI" + suffix}, {FILTER_ROUGHNESS, "T4_Roughness" + suffix}, {FILTER_CURVATURE, "T5_Curvature" + suffix}});
+    }
+
+    /**
+     * @brief Compute the plane coefficient layer of a kernel: the least-square fitting plane (a, b, c, d) of every window
+     * and its number of points (PLANE_LAYER_BANDS channels). Coefficients are expressed in the local frame of each window
+     * (metric units, origin at the window center) as used by computePlaneDistance. Any later window filter over the
+     * same (raster, kernel) consumes them instead of refitting
+     *
+     * @param raster Bathymetry Layer interpreted as a 2.5D map, where depth is defined for every pixel as Z = f(X,Y)
+     * @param kernel Binary mask Layer that is used to determine the subset S of points to be used for plane calculation
+     * @param mask Global raster mask that can be used as ROI
+     * @param dst Resulting multi-band raster Layer. It can be exported as geoTIFF and read back with loadPlaneLayer
+     * @return int Error code, if any
+     */
+    int Pipeline::computePlaneLayer(std::string raster, std::string kernel, std::string mask, std::string dst)
+    {
+        if (verbosity > VERBOSITY_0)
+        {
+            logc.debug("computePlaneLayer", "Calling fused applyWindowFilter");
+        }
+        return applyWindowFilter(raster, kernel, mask, std::map<int, std::string>{{FILTER_PLANE, dst}});
+    }
+
+    /**
+     * @brief Read a plane coefficient layer exported by a previous run (see computePlaneLayer), so the window filters of
+     * (raster, kernel) skip the plane fitting. The file is rejected if its name does not carry the identity of (raster,
+     * kernel) (see getPlaneCacheTag), or if its size or number of bands does not match
+     *
+     * @param raster Bathymetry Layer the planes were computed for
+     * @param kernel Kernel Layer the planes were computed for
+     * @param file geoTIFF file with PLANE_LAYER_BANDS bands, named <name>_<tag>.tif
+     * @param dst Name of the raster Layer that will contain the plane coefficients
+     * @return int Error code, if any
+     */
+    int Pipeline::loadPlaneLayer(std::string raster, std::string kernel, std::string file, std::string dst)
+    {
+        ostringstream s;
+        auto apSrc = dynamic_pointer_cast<RasterLayer>(getLayer(raster));
+        if (apSrc == nullptr)
+        {
+            s << "Base bathymetry Layer [" << yellow << raster << red << "] not found...";
+            logc.error("p::loadPlaneLayer", s);
+            return LAYER_NOT_FOUND;
+        }
+        std::string tag = getPlaneCacheTag(raster, kernel);
+        if (tag.empty() || file.find("_" + tag + ".tif") == std::string::npos)
+        {
+            s << "File [" << file << "] was not computed for [" << raster << "] and [" << kernel << "], expected tag: " << tag;
+            logc.error("p::loadPlaneLayer", s);
+            return ERROR_WRONG_ARGUMENT;
+        }
+        if (isAvailable(dst))
+            createLayer(dst, LAYER_RASTER);
+        auto apDst = dynamic_pointer_cast<RasterLayer>(getLayer(dst));
+        if (apDst == nullptr)
+        {
+            s << "could not create <RasterLayer>: " << dst;
+            logc.error("p::loadPlaneLayer", s);
+            return LAYER_NOT_FOUND;
+        }
+        if (apDst->readTIFF(file) != NO_ERROR)
+            return ERROR_GDAL_FAILOPEN;
+        if (apDst->rasterData.channels() != PLANE_LAYER_BANDS || apDst->rasterData.size() != apSrc->rasterData.size())
+        {
+            s << "File [" << file << "] is not a plane layer of [" << raster << "]: " << apDst->rasterData.channels()
+              << " bands, size " << apDst->rasterData.size();
+            logc.error("p::loadPlaneLayer", s);
+            return ERROR_WRONG_ARGUMENT;
+        }
+#pragma omp critical(planeLayers)
+        planeLayers[std::make_pair(raster, kernel)] = dst;
+        return NO_ERROR;
+    }
+
+    /**
+     * @brief Identity of the plane coefficients of (raster, kernel): the size [px] of the unrotated kernel, and a hash of
+     * the raster samples and georeference, the rotated kernel and every setting the window filters fit their planes with
+     * (window engine, hull solver, point budget, elevation quantisation, raster element type and plane fit revision).
+     * Plane cache files carry it in their name, so the planes of another survey, vehicle, heading or setting are never
+     * reused
+     *
+     * @param raster Bathymetry Layer
+     * @param kernel Kernel Layer, at its current rotation
+     * @return std::string Tag such as "11x28_0123456789abcdef", empty if a layer is missing
+     */
+    std::string Pipeline::getPlaneCacheTag(std::string raster, std::string kernel)
+    {
+        auto apSrc = dynamic_pointer_cast<RasterLayer>(getLayer(raster));
+        auto apKernel = dynamic_pointer_cast<KernelLayer>(getLayer(kernel));
+        if (apSrc == nullptr || apKernel == nullptr)
+            return "";
+        uint64_t h = hashBytes(apKernel->rotatedData, getRasterHash(apSrc));
+        int settings[5] = {(int)parameters.windowEngine, (int)parameters.hullSolver, parameters.pointBudget, (int)sizeof(raster_t), PLANE_LAYER_FIT};
+        h = hashBytes(settings, sizeof(settings), h);
+        h = hashBytes(&parameters.quantizationStep, sizeof(parameters.quantizationStep), h);
+        ostringstream s;
+        s << apKernel->rasterData.cols << "x" << apKernel->rasterData.rows << "_" << std::hex << std::setw(16) << std::setfill('0') << h;
+        return s.str();
+    }
+
+    /**
+     * @brief Select the window engine and tile size (parameters.windowEngine, parameters.tileSize) for a raster and its
+     * vehicle kernel. The choice is read from the cache file (parameters.autotuneCache) when it holds a calibration for
+     * the same kernel size, density bucket, headings and machine; otherwise every strategy is measured on a sample of the
+     * raster (see benchmarkWindowStrategies) and the fastest one is added to the cache. Only the least-squares slope
+     * (FILTER_SLOPE) has alternative strategies to choose from
+     *
+     * @param raster Source raster layer of the window filters
+     * @param kernel Vehicle kernel layer. It is rotated to every heading to get its footprints, and then restored
+     * @param headings Headings [deg] of the run. The moment engine evaluates all of them in a single pass when land runs
+     * its batched slope pre-pass (no plane cache)
+     * @param result Optional output, selected strategy
+     * @return int Error code, if any. The parameters are not modified on error
+     */
+    int Pipeline::autotuneWindowFilter(std::string raster, std::string kernel, std::vector<double> headings, AutotuneChoice *result)
+    {
+        ostringstream s;
+        auto apSrc = dynamic_pointer_cast<RasterLayer>(getLayer(raster));
+        if (apSrc == nullptr)
+        {
+            s << "Base bathymetry Layer [" << yellow << raster << red << "] not found...";
+            logc.error("p::autotuneWindowFilter", s);
+            return LAYER_NOT_FOUND;
+        }
+        auto apKernel = dynamic_pointer_cast<KernelLayer>(getLayer(kernel));
+        if (apKernel == nullptr)
+        {
+            s << "Kernel layer [" << yellow << kernel << red << "] not found...";
+            logc.error("p::autotuneWindowFilter", s);
+            return LAYER_NOT_FOUND;
+        }
+        if (parameters.slopeAlgorithm != FILTER_SLOPE || headings.empty())
+        {
+            s << "Only the least-squares slope with at least one heading can be calibrated, keeping the configured strategy";
+            logc.warn("p::autotuneWindowFilter", s);
+            return ERROR_WRONG_ARGUMENT;
+        }
+        auto apIndex = getValidIndex(apSrc);
+        const KernelFootprint &window = apKernel->bank.window;
+        bool batched = parameters.planeCache.empty();
+        // the calibration is keyed on the density of the sample it times, not on the density of the whole raster
+        cv::Rect roi = getAutotuneSample(*apIndex, window.nPixels);
+        long nSample = roi.empty() ? 0 : apIndex->countRect(roi.y, roi.br().y, roi.x, roi.br().x);
+        AutotuneKey key = {getMachineSignature(), window.nPixels, getDensityBucket(nSample, (long)roi.area()), (int)headings.size(), batched};
+
+        AutotuneChoice choice;
+        if (readAutotuneCache(parameters.autotuneCache, key, choice) != NO_ERROR)
+        {
+            // windows near the border of the sample read the surrounding raster through the NODATA halo, as the complete filter
+            double rotation = apKernel->getRotation();
+            std::vector<KernelFootprint> windows;
+            for (double heading : headings)
+            {
+                apKernel->setRotation(heading);
+                windows.push_back(apKernel->bank.window);
+            }
+            apKernel->setRotation(rotation);
+            KernelFootprint gatherWindow;
+            windows[0].subsample(parameters.pointBudget, gatherWindow);
+            std::vector<AutotuneChoice> trials;
+            if (roi.empty() || benchmarkWindowStrategies(apSrc->rasterData(roi), apSrc->getNoDataValue(), windows, gatherWindow, geoTransform[1],
+                                                         geoTransform[5], batched, choice, &trials) != NO_ERROR)
+            {
+                s << "No valid data to calibrate the window filters of [" << raster << "], keeping the configured strategy";
+                logc.warn("p::autotuneWindowFilter", s);
+                return ERROR_WRONG_ARGUMENT;
+            }
+            if (verbosity > VERBOSITY_1)
+            {
+                for (auto &t : trials)
+                {
+                    s << "Sample " << roi.size() << ": " << (t.windowEngine == ENGINE_GATHER ? "GATHER" : "MOMENTS") << ", tile " << t.tileSize
+                      << " px -> " << t.seconds << " s";
+                    logc.debug("p::autotuneWindowFilter", s);
+                }
+            }
+            if (writeAutotuneCache(parameters.autotuneCache, key, choice) != NO_ERROR)
+            {
+                s << "Could not write the autotune cache [" << parameters.autotuneCache << "]";
+                logc.warn("p::autotuneWindowFilter", s);
+            }
+        }
+        parameters.windowEngine = choice.windowEngine;
+        parameters.tileSize = choice.tileSize;
+        if (result != nullptr)
+            *result = choice;
+        return NO_ERROR;
+    }
+
+    /**
+     * @brief Footprint used by the gathering window filters for a kernel: its window, or the stratified grid subsample of
+     * the window if it holds more pixels than parameters.pointBudget. Only the plane-fit filters (SLOPE, PLANE, DISTANCE,
+     * RESIDUAL and GEOTECH) accept the subsample, so the complete window is returned if any other filter is requested,
+     * or if the geotech sensor is not covered by the window (its points would then be gathered from the subsample). The
+     * deviation of every requested filter on the subsample against the complete window is reported for a sample of
+     * windows, so the accuracy traded for throughput is known
+     *
+     * @param apSrc Source raster layer
+     * @param apKernel Kernel layer, its current rotation is used
+     * @param sx Horizontal pixel scale
+     * @param sy Vertical pixel scale
+     * @param filters Filters evaluated over the footprint
+     * @return KernelFootprint Footprint anchored at the kernel center, see KernelBank::window
+     */
+    KernelFootprint Pipeline::getWindowFootprint(std::shared_ptr<RasterLayer> apSrc, std::shared_ptr<KernelLayer> apKernel, double sx, double sy,
+                                                 std::vector<int> filters)
+    {
+        if (parameters.pointBudget <= 0 || filters.empty())
+            return apKernel->bank.window;
+        const geotechStruct &sensor = parameters.geotechSensor;
+        for (int f : filters)
+        {
+            if (f != FILTER_SLOPE && f != FILTER_PLANE && f != FILTER_DISTANCE && f != FILTER_RESIDUAL && f != FILTER_GEOTECH)
+                return apKernel->bank.window;
+            if (f == FILTER_GEOTECH && !getSensorFootprint(apSrc, sx, sy)->isCoveredBy(apKernel->bank.window))
+                return apKernel->bank.window;
+        }
+        KernelFootprint window;
+        int step = apKernel->bank.window.subsample(parameters.pointBudget, window);
+        if (step > 1)
+        {
+            ostringstream s;
+            s << "Kernel [" << apKernel->layerName << "] subsampled from " << apKernel->bank.window.nPixels << " to " << window.nPixels
+              << " px (grid step " << step << ")";
+            logc.info("p::getWindowFootprint", s);
+            for (int f : filters)
+            {
+                double meanDev;
+                double maxDev = computeSubsampleDeviation(apSrc->rasterData, apSrc->getNoDataValue(), apKernel->bank.window, window, sx, sy, f,
+                                                          sensor.diameter, sensor.z_optimal, sensor.z_suboptimal, SUBSAMPLE_VALIDATION_WINDOWS, &meanDev);
+                std::string unit = (f == FILTER_SLOPE || f == FILTER_PLANE) ? " deg" : (f == FILTER_RESIDUAL ? " m" : "");
+                s << "Filter [" << f << "] deviation against the full window: max " << maxDev << unit << ", mean " << meanDev << unit;
+                logc.info("p::getWindowFootprint", s);
+            }
+        }
+        return window;
+    }
+
+    /**
+     * @brief ROI of the window filters, from the mask layer passed to applyWindowFilter. Only masks that exclude some
+     * valid pixel of the source are returned, so the usual valid data mask (M1_VALID_DataMask) adds no work
+     *
+     * @param apSrc Source raster layer
+     * @param apMask Mask layer (8UC1), non-zero for the pixels to be evaluated
+     * @return cv::Mat The mask data, empty if every valid pixel of the source must be evaluated
+     */
+    cv::Mat Pipeline::getCandidateMask(std::shared_ptr<RasterLayer> apSrc, std::shared_ptr<RasterLayer> apMask)
+    {
+        const cv::Mat &mask = apMask->rasterData;
+        if (mask.type() != CV_8UC1 || mask.size() != apSrc->rasterData.size())
+            return cv::Mat();
+        cv::Mat excluded;
+        computeValidMask(apSrc->rasterData, apSrc->getNoDataValue(), excluded);
+        excluded.setTo(0, mask);
+        return cv::countNonZero(excluded) ? mask : cv::Mat();
+    }
+
+    /**
+     * @brief Report the deviation of a slope map against the double precision least-squares fit of its windows, see
+     * computePrecisionDeviation. Used to validate the float32 raster layers (USE_FLOAT32)
+     *
+     * @param raster Source raster layer of the slope map
+     * @param kernel Kernel layer used to compute the slope map
+     * @param slope Slope map layer
+     */
+    void Pipeline::reportSlopePrecision(std::string raster, std::string kernel, std::string slope)
+    {
+        auto apSrc = dynamic_pointer_cast<RasterLayer>(getLayer(raster));
+        auto apKernel = dynamic_pointer_cast<KernelLayer>(getLayer(kernel));
+        auto apSlope = dynamic_pointer_cast<RasterLayer>(getLayer(slope));
+        if (apSrc == nullptr || apKernel == nullptr || apSlope == nullptr || apSlope->rasterData.size() != apSrc->rasterData.size())
+            return;
+        ostringstream s;
+        double meanDev;
+        double maxDev = computePrecisionDeviation(apSrc->rasterData, apSrc->getNoDataValue(), apKernel->bank.window, geoTransform[1], geoTransform[5],
+                                                  apSlope->rasterData, SUBSAMPLE_VALIDATION_WINDOWS, &meanDev);
+        s << "Slope map [" << slope << "] (" << type2str(apSlope->rasterData.type()) << ") deviation against the double precision fit: max "
+          << maxDev << " deg, mean " << meanDev << " deg";
+        logc.info("p::reportSlopePrecision", s);
+    }
+
+    /**
+     * @brief Retrieve the index of the valid pixels of a raster layer, see ValidIndex. It is built on first use (readTIFF
+     * builds it for the imported raster) and shared by every filter and heading. As the moment tables, it is rebuilt if
+     * the size of the raster changed: layers used as filter sources are not modified in place
+     *
+     * @param apSrc Source raster layer
+     * @return std::shared_ptr<ValidIndex> Index of the valid pixels of the layer
+     */
+    std::shared_ptr<ValidIndex> Pipeline::getValidIndex(std::shared_ptr<RasterLayer> apSrc)
+    {
+        std::shared_ptr<ValidIndex> index;
+#pragma omp critical(windowCaches)
+        {
+            auto it = validIndexes.find(apSrc->layerName);
+            if (it != validIndexes.end() && it->second->rows == apSrc->rasterData.rows && it->second->cols == apSrc->rasterData.cols)
+                index = it->second;
+            else
+            {
+                index = std::make_shared<ValidIndex>();
+                index->build(apSrc->rasterData, apSrc->getNoDataValue());
+                validIndexes[apSrc->layerName] = index;
+            }
+        }
+        return index;
+    }
+
+    /**
+     * @brief Hash of a raster layer: its samples (whatever their storage type), NODATA value and georeference. It is
+     * computed once per layer and shared by every heading
+     *
+     * @param apSrc Source raster layer
+     * @return uint64_t FNV-1a hash
+     */
+    uint64_t Pipeline::getRasterHash(std::shared_ptr<RasterLayer> apSrc)
+    {
+        uint64_t h;
+#pragma omp critical(windowCaches)
+        {
+            auto it = rasterHashes.find(apSrc->layerName);
+            if (it != rasterHashes.end())
+                h = it->second;
+            else
+            {
+                double nodata = apSrc->getNoDataValue();
+                h = hashBytes(apSrc->rasterData);
+                h = hashBytes(&nodata, sizeof(nodata), h);
+                h = hashBytes(geoTransform, sizeof(geoTransform), h);
+                rasterHashes[apSrc->layerName] = h;
+            }
+        }
+        return h;
+    }
+
+    /**
+     * @brief Retrieve the moment table of a raster layer, see MomentTable. The table does not depend on the kernel nor
+     * its heading, so it is built once and shared by the window filters of every heading. Quantised layers (see
+     * RasterLayer::quantize) get the exact integer table, unless their elevation range does not fit it
+     *
+     * @param apSrc Source raster layer
+     * @return std::shared_ptr<MomentTable> Moment table of the layer
+     */
+    std::shared_ptr<MomentTable> Pipeline::getMomentTable(std::shared_ptr<RasterLayer> apSrc)
+    {
+        std::shared_ptr<MomentTable> table;
+#pragma omp critical(windowCaches)
+        {
+            auto it = momentTables.find(apSrc->layerName);
+            if (it != momentTables.end() && it->second->rows == apSrc->rasterData.rows && it->second->cols == apSrc->rasterData.cols)
+                table = it->second;
+            else
+            {
+                // built inside the critical section: concurrent headings wait for the table instead of duplicating it
+                // build() returns the number of valid samples, a raster without any valid sample still yields an empty table
+                table = std::make_shared<MomentTable>();
+                if (!apSrc->isQuantized() || table->buildQuantized(apSrc->rasterData, apSrc->getNoDataValue(), apSrc->quantScale, apSrc->quantOffset) == ERROR_WRONG_ARGUMENT)
+                {
+                    if (apSrc->isQuantized())
+                    {
+                        std::ostringstream s;
+                        s << "Elevation range of [" << apSrc->layerName << "] exceeds the integer moment table, using the floating point table";
+                        logc.warn("p::getMomentTable", s);
+                    }
+                    table->build(apSrc->rasterData, apSrc->getNoDataValue());
+                }
+                momentTables[apSrc->layerName] = table;
+            }
+        }
+        return table;
+    }
+
+    /**
+     * @brief Retrieve the geotech sensor footprint (parameters.geotechSensor) for a raster layer, see SensorFootprint.
+     * The sensor circle does not depend on the heading, so it is built once and shared by every heading. It is rebuilt
+     * if the layout (stride or halo) of the raster changed
+     *
+     * @param apSrc Source raster layer
+     * @param sx Horizontal pixel scale
+     * @param sy Vertical pixel scale
+     * @return std::shared_ptr<SensorFootprint> Sensor footprint for the layer
+     */
+    std::shared_ptr<SensorFootprint> Pipeline::getSensorFootprint(std::shared_ptr<RasterLayer> apSrc, double sx, double sy)
+    {
+        std::shared_ptr<SensorFootprint> sensor;
+#pragma omp critical(windowCaches)
+        {
+            auto it = sensorFootprints.find(apSrc->layerName);
+            if (it != sensorFootprints.end() && it->second->stride == (int)apSrc->rasterData.step1() &&
+                it->second->margin == getRasterHalo(apSrc->rasterData))
+                sensor = it->second;
+            else
+            {
+                sensor = std::make_shared<SensorFootprint>();
+                sensor->build(parameters.geotechSensor.diameter, sx, sy, apSrc->rasterData);
+                sensorFootprints[apSrc->layerName] = sensor;
+            }
+        }
+        return sensor;
+    }
+
+    /**
+     * @brief Retrieve the plane coefficients of (raster, kernel) computed by computePlaneLayer or read by loadPlaneLayer
+     *
+     * @return cv::Mat CV_64FC(PLANE_LAYER_BANDS) container, empty if not available (or its size does not match the raster)
+     */
+    cv::Mat Pipeline::getPlaneData(std::string raster, std::string kernel)
+    {
+        std::string name;
+#pragma omp critical(planeLayers)
+        {
+            auto it = planeLayers.find(std::make_pair(raster, kernel));
+            if (it != planeLayers.end())
+                name = it->second;
+        }
+        if (name.empty())
+            return cv::Mat();
+        auto apPlane = dynamic_pointer_cast<RasterLayer>(getLayer(name));
+        auto apSrc = dynamic_pointer_cast<RasterLayer>(getLayer(raster));
+        if (apPlane == nullptr || apSrc == nullptr || apPlane->rasterData.channels() != PLANE_LAYER_BANDS ||
+            apPlane->rasterData.size() != apSrc->rasterData.size())
+            return cv::Mat();
+        return apPlane->rasterData;
+    }
+
     /**
      * @brief Generate final binary landability map by combining the three intermediate maps: M3 = SRC1 | SRC2 | SRC3
      *
@@ -1941,9 +3057,10 @@ namespace lad
         // logical OR for the three source layers (pixel wise). We assume the input raster data is CV_8UC1.
         // the destination mask will be retrieved from the first source layer
         cv::Mat tmp;
-        cv::bitwise_or(apSrc1->rasterData, apSrc2->rasterData, tmp, apSrc1->rasterMask);
-        cv::bitwise_or(apSrc3->rasterData, tmp, apDst->rasterData, apSrc1->rasterMask);
-        cv::bitwise_not(apDst->rasterData, apDst->rasterData, apSrc1->rasterMask);
+        cv::Mat mask = apSrc1->getMask();
+        cv::bitwise_or(apSrc1->rasterData, apSrc2->rasterData, tmp, mask);
+        cv::bitwise_or(apSrc3->rasterData, tmp, apDst->rasterData, mask);
+        cv::bitwise_not(apDst->rasterData, apDst->rasterData, mask);
         // now we invert: 0 - NON LANDABLE, 1 - LANDABLE, so we can use to mask/multiply the measurability map
 
         apDst->setNoDataValue(apSrc1->getNoDataValue());
@@ -1998,10 +3115,12 @@ namespace lad
         }
 
         cv::Mat tmp;
-        apSrc1->rasterData.convertTo(tmp, CV_64FC1, 1 / 255.0); // rescale from 0/255 to 0/1
+        apSrc1->rasterData.convertTo(tmp, apSrc2->rasterData.type(), 1 / 255.0); // rescale from 0/255 to 0/1, same type as the measurability
 
         // DANGER
         cv::multiply(tmp, apSrc2->rasterData, apDst->rasterData); // now, no landability means no measure can be taken!
+        // even where the measurability was not evaluated (NODATA, e.g. skipped by the exclusion gating)
+        apDst->rasterData.setTo(0, apSrc1->rasterData == 0);
 
         apDst->setNoDataValue(apSrc1->getNoDataValue());
         apDst->copyGeoProperties(apSrc1);
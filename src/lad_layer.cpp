@@ -156,11 +156,56 @@ namespace lad
 
     /**
      * @brief Updates the content of rasterMask matrix by comparing rasterData content with explicit NO-DATA value provided as argument
-     * @details The resulting mask is a single channel 8-bit matrix containing 0 for invalid pixels in rasterData and 255 for valid pixels
+     * @details The resulting mask is a single channel 8-bit matrix containing 0 for invalid pixels in rasterData and 255 for valid pixels.
+     * The comparison is deferred to the first getMask call, so layers whose mask is never read do not store one
      * @param nd NO-DATA scalar value to be used for comparison. 
      */
     void RasterLayer::updateMask(double nd){
-        cv::compare(rasterData, nd, rasterMask, CMP_NE);
+#pragma omp critical(layerMask)
+        {
+            rasterMask.release(); // may be shared with other layers, it is never overwritten in place
+            maskDerived = true;
+            maskNoData = nd;
+        }
+    }
+
+    /**
+     * @brief Retrieve the valid data mask of the layer. A mask requested by updateMask is derived from the current
+     * rasterData on first use, and kept until the next updateMask or setMask
+     *
+     * @return cv::Mat Single channel 8-bit mask (255 valid), empty if the layer has no mask. The buffer may be shared with
+     * other layers, so it must not be modified in place
+     */
+    cv::Mat RasterLayer::getMask(){
+        cv::Mat mask;
+#pragma omp critical(layerMask)
+        {
+            if (maskDerived && rasterMask.empty() && !rasterData.empty()){
+                if (rasterData.channels() > 1){ // multi-band layers are masked by their first band
+                    cv::Mat band;
+                    cv::extractChannel(rasterData, band, 0);
+                    cv::compare(band, maskNoData, rasterMask, CMP_NE); // multi-band layers (planes) always use the NODATA sentinel
+                }
+                else
+                    computeValidMask(rasterData, maskNoData, rasterMask);
+            }
+            mask = rasterMask;
+        }
+        return mask;
+    }
+
+    /**
+     * @brief Set an explicit valid data mask. The buffer is shared rather than copied: layers propagating the mask of
+     * their source (see Pipeline::copyMask) do not store a copy of their own
+     *
+     * @param mask Single channel 8-bit mask (255 valid)
+     */
+    void RasterLayer::setMask(const cv::Mat &mask){
+#pragma omp critical(layerMask)
+        {
+            rasterMask = mask;
+            maskDerived = false;
+        }
     }
 
     /**
@@ -177,13 +222,18 @@ namespace lad
      */
     void RasterLayer::updateStats(){
         // first, let's find min, max using opencv methods
+        // stats of multi-band layers are those of their first band
+        cv::Mat band = rasterData;
+        if (rasterData.channels() > 1)
+            cv::extractChannel(rasterData, band, 0);
+        cv::Mat mask = getMask();
         double min, max;
-        cv::minMaxLoc(rasterData, &min, &max, nullptr, nullptr, rasterMask);
+        cv::minMaxLoc(band, &min, &max, nullptr, nullptr, mask);
         rasterStats[LAYER_MIN] = min;
         rasterStats[LAYER_MAX] = max;
         // now, let's calculate the mean value of the valid data
         Scalar mean, stdev;
-        cv::meanStdDev(rasterData, mean, stdev, rasterMask);
+        cv::meanStdDev(band, mean, stdev, mask);
         rasterStats[LAYER_MEAN] = mean[0];
         rasterStats[LAYER_STDEV] = stdev[0];
     }
@@ -206,7 +256,7 @@ namespace lad
      * 
      * @param name 
      */
-    int RasterLayer::readTIFF(std::string name){
+    int RasterLayer::readTIFF(std::string name, double quantStep){
 
     std::ostringstream s;
     // create the container and the open input file
@@ -226,32 +276,152 @@ namespace lad
     inputGeotiff.GetDimensions(layerDimensions);
     layerProjection = std::string(inputGeotiff.GetProjection());
 
-    float **apData; //pull 2D float matrix containing the image data for Band 1
-    apData = inputGeotiff.GetRasterBand(1);
-    if (apData == nullptr)
+    // multi-band layers (e.g. plane coefficient maps) are read at full precision, one channel per band
+    int nBands = poDataset->GetRasterCount();
+    if (nBands > 1)
     {
-        s << "Error opening Geotiff file: " << yellow << name;
-        logc.error("rl::readTIFF", "Error reading input geoTIFF data: NULL");
-        return ERROR_GDAL_FAILOPEN;
+        std::vector<cv::Mat> bands(nBands);
+        for (int b = 0; b < nBands; b++)
+        {
+            bands[b] = cv::Mat(layerDimensions[1], layerDimensions[0], CV_64FC1);
+            if (poDataset->GetRasterBand(b + 1)->RasterIO(GF_Read, 0, 0, layerDimensions[0], layerDimensions[1], bands[b].ptr<double>(),
+                                                          layerDimensions[0], layerDimensions[1], GDT_Float64, 0, 0) != CE_None)
+            {
+                s << "Error reading band [" << b + 1 << "] of geoTIFF file: " << yellow << name;
+                logc.error("rl::readTIFF", s);
+                return ERROR_GDAL_FAILOPEN;
+            }
+        }
+        cv::merge(bands, rasterData);
+        setNoDataValue(inputGeotiff.GetNoDataValue());
+        updateMask();
+        updateStats();
+        return NO_ERROR;
     }
 
-    cv::Mat tiff(layerDimensions[1], layerDimensions[0], CV_64FC1); // cv container for tiff data . WARNING: cv::Mat constructor is failing to initialize with apData
-    // cout << "Dim: [" << layerDimensions[0] << "x" << layerDimensions[1] << endl;
-    for (int i = 0; i < layerDimensions[1]; i++)
+    // integer files (e.g. quantised layers exported by writeLayer) carry the elevation step as band scale and offset
+    GDALRasterBand *band = poDataset->GetRasterBand(1);
+    int hasScale = 0, hasOffset = 0;
+    double bandScale = band->GetScale(&hasScale);
+    double bandOffset = band->GetOffset(&hasOffset);
+    if (!hasScale)
+        bandScale = 1.0;
+    if (!hasOffset)
+        bandOffset = 0.0;
+    double fileNoData = inputGeotiff.GetNoDataValue();
+
+    cv::Mat tiff(layerDimensions[1], layerDimensions[0], RASTER_TYPE); // cv container for tiff data . WARNING: cv::Mat constructor is failing to initialize with apData
+    GDALDataType bandType = band->GetRasterDataType();
+    if (bandType == GDT_Byte || bandType == GDT_UInt16 || bandType == GDT_Int16 || bandType == GDT_Int32)
     {
-        for (int j = 0; j < layerDimensions[0]; j++)
+        // integer bands are read as int32: the float32 buffer of GetRasterBand would round samples beyond 2^24
+        cv::Mat samples(layerDimensions[1], layerDimensions[0], CV_32SC1);
+        if (band->RasterIO(GF_Read, 0, 0, layerDimensions[0], layerDimensions[1], samples.ptr<int32_t>(), layerDimensions[0],
+                           layerDimensions[1], GDT_Int32, 0, 0) != CE_None)
+        {
+            s << "Error reading integer band of geoTIFF file: " << yellow << name;
+            logc.error("rl::readTIFF", s);
+            return ERROR_GDAL_FAILOPEN;
+        }
+        for (int i = 0; i < layerDimensions[1]; i++)
         {
-            tiff.at<double>(cv::Point(j, i)) = (double)apData[i][j]; // swap row/cols from matrix to OpenCV container
+            const int32_t *q = samples.ptr<int32_t>(i);
+            raster_t *p = tiff.ptr<raster_t>(i);
+            for (int j = 0; j < layerDimensions[0]; j++)
+                p[j] = (q[j] == fileNoData) ? (raster_t)fileNoData : (raster_t)(bandOffset + bandScale * q[j]);
         }
     }
+    else
+    {
+        float **apData; //pull 2D float matrix containing the image data for Band 1
+        apData = inputGeotiff.GetRasterBand(1);
+        if (apData == nullptr)
+        {
+            s << "Error opening Geotiff file: " << yellow << name;
+            logc.error("rl::readTIFF", "Error reading input geoTIFF data: NULL");
+            return ERROR_GDAL_FAILOPEN;
+        }
+
+        // band 1 is read as float32, so storing it as float32 raster layers (USE_FLOAT32) is lossless
+        // cout << "Dim: [" << layerDimensions[0] << "x" << layerDimensions[1] << endl;
+        for (int i = 0; i < layerDimensions[1]; i++)
+        {
+            for (int j = 0; j < layerDimensions[0]; j++)
+            {
+                tiff.at<raster_t>(cv::Point(j, i)) = (raster_t)apData[i][j]; // swap row/cols from matrix to OpenCV container
+            }
+        }
+        if (bandScale != 1.0 || bandOffset != 0.0)
+        {
+            tiff.forEach<raster_t>([&](raster_t &v, const int *) {
+                if (v != fileNoData)
+                    v = bandOffset + bandScale * v;
+            });
+        }
+    }
+#ifdef USE_NAN_NODATA
+    // NODATA samples are stored as NaN, the file NODATA value is restored by writeLayer
+    tiff.setTo(RASTER_NODATA, tiff == fileNoData);
+    fileNoData = RASTER_NODATA;
+#endif
     tiff.copyTo(rasterData);
 
-    setNoDataValue(inputGeotiff.GetNoDataValue());
+    setNoDataValue(fileNoData);
     updateMask();
+    if (quantStep > 0 && quantize(quantStep) != NO_ERROR)
+        return ERROR_WRONG_ARGUMENT;
     updateStats();
     return NO_ERROR;
     }
 
+    /**
+     * @brief Quantise the valid samples of rasterData to integer multiples of step, relative to an offset at the center of
+     * their range. rasterData keeps the dequantised value (offset + step * q) of every sample, and no integer copy is
+     * stored: the integer moment tables (see MomentTable::buildQuantized) and writeLayer recover q from it. quantType
+     * records the integer type of the exported samples (CV_16SC1 if the range fits 16 bits, CV_32SC1 otherwise)
+     *
+     * @param step Elevation step [m], e.g. 0.001 for millimetre quantised bathymetry
+     * @return int Error code, if any
+     */
+    int RasterLayer::quantize(double step){
+        std::ostringstream s;
+        if (step <= 0 || rasterData.empty() || rasterData.type() != RASTER_TYPE){
+            s << "Layer [" << layerName << "] can not be quantised to step [" << step << "]";
+            logc.error("rl::quantize", s);
+            return ERROR_WRONG_ARGUMENT;
+        }
+        cv::Mat mask = getMask();
+        double min = 0, max = 0;
+        if (cv::countNonZero(mask) > 0)
+            cv::minMaxLoc(rasterData, &min, &max, nullptr, nullptr, mask);
+        double offset = step * std::round(0.5 * (min + max) / step);
+        double reach = std::ceil(std::max(max - offset, offset - min) / step);
+        int type;
+        if (reach < INT16_MAX)
+            type = CV_16SC1;
+        else if (reach < INT32_MAX)
+            type = CV_32SC1;
+        else{
+            s << "Elevation range of [" << layerName << "] does not fit int32 with step [" << step << "]";
+            logc.error("rl::quantize", s);
+            return ERROR_WRONG_ARGUMENT;
+        }
+        for (int r = 0; r < rasterData.rows; r++){
+            raster_t *p = rasterData.ptr<raster_t>(r);
+            const uchar *m = mask.ptr<uchar>(r);
+            for (int c = 0; c < rasterData.cols; c++){
+                if (m[c])
+                    p[c] = offset + step * std::llround((p[c] - offset) / step);
+            }
+        }
+        quantScale = step;
+        quantOffset = offset;
+        quantType = type;
+        s << "Quantised [" << layerName << "] to " << (type == CV_16SC1 ? "int16" : "int32") << ", step [" << step << "] offset [" << offset << "]";
+        logc.debug("rl::quantize", s);
+        return NO_ERROR;
+    }
+
     /**
  * @brief Extended method that prints general and raster specific information
  * 
@@ -441,20 +611,30 @@ namespace lad
             return ERROR_WRONG_ARGUMENT;
         }
         double noData = getNoDataValue();
+        if (std::isnan(noData)) // NaN NODATA (USE_NAN_NODATA) is exported as the sentinel, for GIS compatibility
+            noData = DEFAULT_NODATA_VALUE;
         // temporary matrix that will hold the data to be exported
         // Created with the same size, and filled with the currently defined NODATA value
-        cv::Mat tempData(rasterData.size(), CV_64FC1, noData);
+        // Multi-band layers are exported with one band per channel
+        int nBands = rasterData.channels();
+        cv::Mat tempData = cv::Mat(rasterData.rows, rasterData.cols * nBands, CV_64FC1, noData).reshape(nBands);
+        cv::Mat mask = getMask();
         // before exporting, we need to verify if the data to be exported is already CV_64F
         if (rasterData.depth() != CV_64F){
             cv::Mat raster64;
             rasterData.convertTo(raster64, CV_64F);
             s <<  "Converted [" << yellow << layerName << reset << "] to CV_64F"; 
             // logc.info ("rl::writeLayer", s);
-            raster64.copyTo(tempData, rasterMask);
+            raster64.copyTo(tempData, mask);
         }
         else{
-            rasterData.copyTo(tempData, rasterMask);
+            rasterData.copyTo(tempData, mask);
         }
+#ifdef USE_NAN_NODATA
+        // masks are not updated by the layer arithmetic, so NaN samples may remain inside the mask
+        cv::Mat flat = tempData.reshape(1);
+        flat.setTo(noData, flat != flat);
+#endif
 
         // exporting as CSV in the pixel domain
         if (fileFmt == FMT_CSV){
@@ -489,21 +669,49 @@ namespace lad
         char **optionsForTIFF = NULL;
         optionsForTIFF = CSLSetNameValue(optionsForTIFF, "COMPRESS", "LZW");
         driverGeotiff = GetGDALDriverManager()->GetDriverByName("GTiff");
-        geotiffDataset = driverGeotiff->Create(outputFilename.c_str(), ncols, nrows, 1, GDT_Float64, optionsForTIFF);
+        // float32 layers (USE_FLOAT32) are written as Float32, GDAL converts the double staging rows on the fly
+        GDALDataType fileType = (rasterData.depth() == CV_32F) ? GDT_Float32 : GDT_Float64;
+        // quantised layers are written as integers, with their elevation step as band scale and offset (see readTIFF)
+        bool quantized = isQuantized() && nBands == 1;
+        if (quantized)
+            fileType = (quantType == CV_16SC1) ? GDT_Int16 : GDT_Int32;
+        geotiffDataset = driverGeotiff->Create(outputFilename.c_str(), ncols, nrows, nBands, fileType, optionsForTIFF);
         geotiffDataset->SetGeoTransform(transformMatrix);
         // cout << "[r.writeLayer] Projection string:" << endl;
         // cout << layerProjection.c_str() << endl;
         geotiffDataset->SetProjection(layerProjection.c_str());
         // \todo figure out if we need to convert/cast the cvMat to float/double for all layers
         int errcode;
+        if (quantized){
+            GDALRasterBand *band = geotiffDataset->GetRasterBand(1);
+            int32_t qNoData = (fileType == GDT_Int16) ? INT16_MIN : INT32_MIN;
+            band->SetNoDataValue(qNoData);
+            band->SetScale(quantScale);
+            band->SetOffset(quantOffset);
+            // the integer samples are recovered from the dequantised elevation, one row at a time
+            std::vector<int32_t> rowQuant(ncols);
+            for (int row = 0; row < nrows; row++){
+                const double *p = tempData.ptr<double>(row);
+                const uchar *m = mask.empty() ? nullptr : mask.ptr<uchar>(row);
+                for (int col = 0; col < ncols; col++)
+                    rowQuant[col] = ((m == nullptr || m[col]) && p[col] != noData) ? (int32_t)std::llround((p[col] - quantOffset) / quantScale) : qNoData;
+                errcode = band->RasterIO(GF_Write, 0, row, ncols, 1, rowQuant.data(), ncols, 1, GDT_Int32, 0, 0);
+            }
+            GDALClose(geotiffDataset);
+            return NO_ERROR;
+        }
         double *rowBuff = (double*) CPLMalloc(sizeof(double)*ncols);
-        geotiffDataset->GetRasterBand(1)->SetNoDataValue (noData);       
-        for(int row=0; row<nrows; row++) {
-            for(int col=0; col<ncols; col++) {
-                rowBuff[col] = (double) tempData.at<double>(cv::Point(col,row)); // tempData should be CV_64F
+        for (int b=0; b<nBands; b++){
+            geotiffDataset->GetRasterBand(b+1)->SetNoDataValue (noData);
+            for(int row=0; row<nrows; row++) {
+                const double *p = tempData.ptr<double>(row) + b; // tempData should be CV_64F
+                for(int col=0; col<ncols; col++) {
+                    rowBuff[col] = p[col*nBands];
+                }
+                errcode = geotiffDataset->GetRasterBand(b+1)->RasterIO(GF_Write, 0, row,ncols, 1, rowBuff, ncols, 1, GDT_Float64, 0, 0);
             }
-            errcode = geotiffDataset->GetRasterBand(1)->RasterIO(GF_Write, 0, row,ncols, 1, rowBuff, ncols, 1, GDT_Float64, 0, 0);
         }
+        CPLFree(rowBuff);
 
         GDALClose(geotiffDataset) ;
         return NO_ERROR;
@@ -520,6 +728,34 @@ namespace lad
         return (sqrt(x*x + y*y));
     }        
 
+    /**
+     * @brief Reallocate rasterData as the central region of a larger buffer, surrounded by a halo of <size> pixels filled
+     * with the NO-DATA value of the layer. rasterData keeps its size and content, so every consumer works as before, while
+     * the window filters can read the complete footprint of border pixels with no clamping (see getRasterHalo)
+     * @details The halo is lost if rasterData is later reassigned (e.g. clone or convertTo into it)
+     *
+     * @param size Width [px] of the halo on every side
+     * @return int Error code, if any
+     */
+    int RasterLayer::setHalo(int size){
+        if (size < 0 || rasterData.empty() || rasterData.channels() > 4)
+            return ERROR_WRONG_ARGUMENT;
+        cv::Mat padded;
+        // BORDER_ISOLATED: if rasterData is already padded, the previous halo must not be used as border source
+        cv::copyMakeBorder(rasterData, padded, size, size, size, size, cv::BORDER_CONSTANT | cv::BORDER_ISOLATED, cv::Scalar::all(noDataValue));
+        rasterData = padded(cv::Rect(size, size, rasterData.cols, rasterData.rows));
+        return NO_ERROR;
+    }
+
+    /**
+     * @brief Width of the NO-DATA halo that surrounds rasterData, see setHalo
+     *
+     * @return int Halo width [px], zero if rasterData is not padded
+     */
+    int RasterLayer::getHalo(){
+        return getRasterHalo(rasterData);
+    }
+
     /**
  * @brief Extended method that prints general and kernel specific information
  * 
@@ -551,6 +787,7 @@ namespace lad
         r.at<double>(1,2) += bbox.height/2.0 - rasterData.rows/2.0;
 
         cv::warpAffine(rasterData, rotatedData, r, bbox.size());
+        bank.build(rotatedData);
     }
 
     /**
@@ -143,7 +143,7 @@ namespace lad
                 row = i / cols;
                 col = (i % cols);
                 // now, let's retrieve the pixel value and its spatial coordinates
-                pz = matrix.at<double>(row, col);
+                pz = matrix.at<raster_t>(row, col);
                 // pz = matrix->at<double>(cv::Point(col,row));
                 if (pz != 0.0f)
                 { // only non-NULL points are included (those are assumed to be invalid data points)
@@ -183,67 +183,41 @@ namespace lad
      */
     int convertMatrix2Vector_Masked(const cv::Mat &matrix, const cv::Mat &mask1, const cv::Mat &mask2, double sx, double sy, std::vector<KPoint> &master, double *acum, std::vector<KPoint> &sensor, double diameter)
     {
-
-        // we need to create the i,j indexing variables to compute the Point3D (X,Y) coordinates, so we go for at<T_> access mode of cvMat container
-        int cols = matrix.cols; // the input image, and the two masks should share the same dimensions
-        double cols_2 = cols / 2.0f;
+        // the input image, and the two masks should share the same dimensions
+        int cols = matrix.cols;
         int rows = matrix.rows;
-        double rows_2 = rows / 2.0f; // constantly used as rows/2 inside of the parallel loop.. No need to recalculate them
-        // std::vector<KPoint> master; // preallocating space does not improve it, maybe we are not triggering resize
-
-        size_t total_elem = cols * rows;              // expected input vector size
         double diam_th = 0.25f * diameter * diameter; // precompute it once, we do not need to square it every iteration
         int r = 0;
-#pragma omp parallel
+        // Sequential scan using row pointers. It is called from inside the (parallel) sliding window loop, and keeps the
+        // same point ordering as convertMatrix2Vector_Points. Points are appended, so <master> and <sensor> can be reused buffers
+        for (int row = 0; row < rows; row++)
         {
-            // TODO: rollback to for x,y or use contiguous pointer format (row,col) to SIMD px,py calculation
-            // Also, it will remove the i->row,col modulo and division operation
-            std::vector<KPoint> slave; // preallocating space does not improve it
-#pragma omp for nowait
-            for (int i = 0; i < total_elem; i++) // single index iteration allows using omp parallel
+            const raster_t *z = matrix.ptr<raster_t>(row);
+            const uchar *m1 = mask1.ptr<uchar>(row);
+            const uchar *m2 = mask2.ptr<uchar>(row);
+            double py = (row - rows / 2) * sy; // This is necessary to speed-up the geotech sensor diameter-based masking
+            for (int col = 0; col < cols; col++)
             {
-                double px, py, pz;
-
-                // let's calculate the index
-                int row, col;
-                row = i / cols;
-                col = (i % cols);
-
                 // let's check with both masks
-                if (mask2.at<unsigned char>(row, col))
-                    if (mask1.at<unsigned char>(row, col))
+                if (!m1[col] || !m2[col])
+                    continue;
+                double pz = z[col];
+                if (pz != 0.0f)
+                {                                      // only non-NULL points are included (those are assumed to be invalid data points)
+                    double px = (col - cols / 2) * sx; // Centering the points
+                    master.emplace_back(px, py, pz);
+                    *acum = *acum + pz;
+
+                    // snippet from pointsInSensor
+                    double _d = px * px + py * py;
+                    if (_d < diam_th) // no need to extract sqrt, just squared both sides
                     {
-                        pz = matrix.at<double>(row, col);
-                        // pz = matrix->at<double>(cv::Point(col,row));
-                        if (pz != 0.0f)
-                        {                               // only non-NULL points are included (those are assumed to be invalid data points)
-                            px = (col - cols / 2) * sx; // Centering the points
-                            py = (row - rows / 2) * sy; // This is necessary to speed-up the geotech sensor diameter-based masking
-                            KPoint newPoint(px, py, pz);
-                            slave.push_back(newPoint); // we could ignore the scale and correct it AFTER plane-fitting
-                            *acum = *acum + pz;
-
-                            // snippet from pointsInSensor
-                            double _d = px * px + py * py;
-                            if (_d < diam_th) // no need to extract sqrt, just squared both sides
-                            {
-                                r++; // we keep track of total of inserted points, as safe check return value
-                                [[unlikely]] sensor.push_back(newPoint);
-                            }
-                        }
-                    } // end of for
-            }         // end of for
-// ####################################################
-// reduction section when slave/master omp mode is used
-#pragma omp critical
-            {
-                master.insert(master.end(),
-                              std::make_move_iterator(slave.begin()),
-                              std::make_move_iterator(slave.end()));
+                        r++; // we keep track of total of inserted points, as safe check return value
+                        [[unlikely]] sensor.emplace_back(px, py, pz);
+                    }
+                }
             }
         }
-
-        // CGAL_PROFILER("calls to convertMatrix2Vector_Points");
         return r;
     }
 
@@ -285,7 +259,7 @@ namespace lad
                 row = i / cols;
                 col = (i % cols);
                 // now, let's retrieve the pixel value and its spatial coordinates
-                pz = matrix.at<double>(row, col);
+                pz = matrix.at<raster_t>(row, col);
                 // pz = matrix->at<double>(cv::Point(col,row));
                 if (pz != 0.0f)
                 {                               // only non-NULL points are included (those are assumed to be invalid data points)
@@ -372,7 +346,7 @@ namespace lad
                 row = i / cols;
                 col = (i % cols);
                 // now, let's retrieve the pixel value and its spatial coordinates
-                pz = matrix.at<double>(row, col);
+                pz = matrix.at<raster_t>(row, col);
                 // pz = matrix->at<double>(cv::Point(col,row));
                 if (pz != 0.0f)
                 {                                         // only non-NULL points are included (those are assumed to be invalid data points)
@@ -428,7 +402,7 @@ namespace lad
      * @param points vector containing the 3D points to be projected against the plane
      * @return std::vector<double> vector containing the distance of <points> against <plane>. It keeps the same input <points> order
      */
-    std::vector<double> computePlaneDistance(KPlane plane, std::vector<KPoint> points)
+    std::vector<double> computePlaneDistance(KPlane plane, const std::vector<KPoint> &points)
     {
         double a = plane.a(); // for faster access, less overhead calling the methods
         double b = plane.b();
@@ -495,118 +469,362 @@ namespace lad
     }
 
     /**
-     * @brief
+     * @brief Computes the normal distance (minimum) of every KPoint provided in the vector <point> to the KPlane <plane>.
+     * Allocation-free version: the results are written into a caller owned vector, which can be reused between calls
      *
-     * @param points Vector of 3D points to be fitted in a plane
+     * @param plane Reference plane. The distance to points is using the closest (normal) projection onto this plane
+     * @param points vector containing the 3D points to be projected against the plane
+     * @param distances output vector containing the distance of <points> against <plane>. Previous content is discarded
+     * @return int number of computed distances
+     */
+    int computePlaneDistance(KPlane plane, const std::vector<KPoint> &points, std::vector<double> &distances)
+    {
+        double a = plane.a();
+        double b = plane.b();
+        double c = plane.c();
+        double d = plane.d();
+        size_t total = points.size();
+        distances.resize(total);
+        for (size_t i = 0; i < total; i++)
+        {
+            const KPoint &p = points[i];
+            distances[i] = a * p[0] + b * p[1] + c * p[2] + d;
+        }
+        return total;
+    }
+
+    /**
+     * @brief Signed double area of the 2D triangle (a, b, c). Positive for counter-clockwise triangles
+     */
+    static inline double orientation2D(double ax, double ay, double bx, double by, double cx, double cy)
+    {
+        return (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+    }
+
+    /**
+     * @brief Supporting plane of the upper convex hull of a height field above the query point (qx, qy). Rather than
+     * building the full 3D hull, it solves the linear program min h(q) s.t. h(p_i) >= z_i, whose optimal basis is the
+     * hull facet crossed by a vertical line at q. The LP is solved as a dual simplex walk over triangles of points that
+     * contain q (in the XY projection): the most violating point enters the basis, and leaves the vertex opposite to the
+     * edge crossed by the ray p->q, so the height at q never decreases. It returns the same facet as the CGAL ray query
+     * of computeConvexHullPlaneCGAL, up to a 1e-9 tolerance in the point-to-plane height
+     *
+     * @param points Vector of 3D points, relative to the query point
+     * @param plane Resulting facet plane, with its normal pointing upwards. Vertical plane (1,0,0,0) if q falls outside the hull
+     * @param qx Query point X coordinate
+     * @param qy Query point Y coordinate
+     * @return int NO_ERROR, ERROR_WRONG_ARGUMENT if q is outside the XY projection of the points, ERROR_NOT_CONVERGED if the walk stalled
+     */
+    int computeUpperEnvelopePlane(const std::vector<KPoint> &points, KPlane &plane, double qx, double qy)
+    {
+        const double eps = 1e-9; // height tolerance, in the same units as Z
+        int n = points.size();
+        plane = KPlane(1, 0, 0, 0); // a vertical plane as an error flag, as the CGAL path does
+        if (n < 3)
+            return ERROR_WRONG_ARGUMENT;
+
+        // Phase 1: initial triangle (a, b, c) containing q. Angles are measured around q, relative to the direction of a.
+        // q is inside iff b (largest positive angle) and c (most negative angle) are at least PI apart
+        int a = -1;
+        for (int i = 0; i < n && a < 0; i++)
+            if (fabs(points[i].x() - qx) + fabs(points[i].y() - qy) > 0)
+                a = i;
+        if (a < 0)
+            return ERROR_WRONG_ARGUMENT;
+        double theta = atan2(points[a].y() - qy, points[a].x() - qx);
+        int b = -1, c = -1;
+        double beta = 0, gamma = 0;
+        for (int i = 0; i < n; i++)
+        {
+            double dx = points[i].x() - qx;
+            double dy = points[i].y() - qy;
+            if (dx == 0 && dy == 0)
+                continue;
+            double rel = atan2(dy, dx) - theta;
+            if (rel > M_PI)
+                rel -= 2 * M_PI;
+            else if (rel <= -M_PI)
+                rel += 2 * M_PI;
+            if (rel > beta)
+            {
+                beta = rel;
+                b = i;
+            }
+            else if (rel < gamma)
+            {
+                gamma = rel;
+                c = i;
+            }
+        }
+        if (b < 0 || c < 0 || (beta - gamma) < M_PI)
+            return ERROR_WRONG_ARGUMENT; // q lies outside (or on the border of) the projected hull, no facet above it
+
+        // Phase 2: dual simplex walk. v[] is always a triangle that contains q
+        int v[3] = {a, b, c};
+        int maxIter = 64 + 2 * n;
+        for (int iter = 0; iter < maxIter; iter++)
+        {
+            const KPoint &p0 = points[v[0]];
+            const KPoint &p1 = points[v[1]];
+            const KPoint &p2 = points[v[2]];
+            // plane normal as (p1-p0)x(p2-p0), nz cannot vanish as the triangle contains q with non-zero area
+            double ux = p1.x() - p0.x(), uy = p1.y() - p0.y(), uz = p1.z() - p0.z();
+            double wx = p2.x() - p0.x(), wy = p2.y() - p0.y(), wz = p2.z() - p0.z();
+            double nx = uy * wz - uz * wy;
+            double ny = uz * wx - ux * wz;
+            double nz = ux * wy - uy * wx;
+            if (fabs(nz) < 1e-300)
+                return ERROR_NOT_CONVERGED;
+
+            // entering point: the one above the current plane by the largest margin
+            int k = -1;
+            double worst = eps;
+            for (int i = 0; i < n; i++)
+            {
+                const KPoint &p = points[i];
+                double h = p0.z() - (nx * (p.x() - p0.x()) + ny * (p.y() - p0.y())) / nz;
+                if (p.z() - h > worst)
+                {
+                    worst = p.z() - h;
+                    k = i;
+                }
+            }
+            if (k < 0)
+            {
+                // optimal: no point above the facet. Build it counter-clockwise so its normal points upwards
+                if (nz > 0)
+                    plane = KPlane(p0, p1, p2);
+                else
+                    plane = KPlane(p0, p2, p1);
+                return NO_ERROR;
+            }
+
+            // leaving vertex: the replacement that keeps q inside the triangle with the largest margin
+            const KPoint &pk = points[k];
+            int leave = -1;
+            double best = -1e-12;
+            for (int i = 0; i < 3; i++)
+            {
+                const KPoint &pj = points[v[(i + 1) % 3]];
+                const KPoint &pl = points[v[(i + 2) % 3]];
+                double area = orientation2D(pk.x(), pk.y(), pj.x(), pj.y(), pl.x(), pl.y());
+                if (fabs(area) < 1e-300)
+                    continue;
+                // barycentric coordinates of q in (pk, pj, pl)
+                double lk = orientation2D(qx, qy, pj.x(), pj.y(), pl.x(), pl.y()) / area;
+                double lj = orientation2D(pk.x(), pk.y(), qx, qy, pl.x(), pl.y()) / area;
+                double ll = 1.0 - lk - lj;
+                double margin = std::min(lk, std::min(lj, ll));
+                if (margin > best)
+                {
+                    best = margin;
+                    leave = i;
+                }
+            }
+            if (leave < 0)
+                return ERROR_NOT_CONVERGED;
+            v[leave] = k;
+        }
+        return ERROR_NOT_CONVERGED;
+    }
+
+    /**
+     * @brief Plane of the convex hull facet located above the center of the window (0,0). The CGAL reference solver is used
+     * unless the upper envelope solver is requested and converges
+     *
+     * @param points Vector of 3D points, relative to the center of the window
+     * @param solver Hull solver (HULL_ENVELOPE | HULL_CGAL)
      * @return KPlane CGAL plane described as a 4D vector: A.X + B.Y + C.Z + D = 0
      */
-    KPlane computeConvexHullPlane(const std::vector<KPoint> &points)
+    KPlane computeConvexHullPlane(const std::vector<KPoint> &points, int solver)
     {
+        KPlane plane(0, 0, 1, 0);
+        if (points.empty()) // early exit
+            return plane;
+        // The query point (0.0001, 0.0001) lies on the diagonal of the pixel grid, so it can fall exactly on a hull edge shared
+        // by two facets or on the hull border. The envelope solver nudges it across the diagonal (ENVELOPE_QUERY_NUDGE) so
+        // its facet is unique, independent of the pivoting path and of the candidate subset (HullSweep)
+        double qx = 0.0001 + ENVELOPE_QUERY_NUDGE;
+        double qy = 0.0001 - ENVELOPE_QUERY_NUDGE;
+        if (solver != HULL_CGAL && computeUpperEnvelopePlane(points, plane, qx, qy) != ERROR_NOT_CONVERGED)
+            return plane;
+        return computeConvexHullPlaneCGAL(points);
+    }
 
+    /**
+     * @brief Plane of the convex hull facet located above the query point, computing the complete 3D convex hull of the
+     * points. The hull mesh is owned by the calling thread and recycled between calls, and as a hull has only a few
+     * tens of facets they are scanned directly rather than through an AABB tree
+     *
+     * @param points Vector of 3D points, relative to the center of the window
+     * @param qx Query point X coordinate
+     * @param qy Query point Y coordinate
+     * @return KPlane CGAL plane described as a 4D vector: A.X + B.Y + C.Z + D = 0
+     */
+    KPlane computeConvexHullPlaneCGAL(const std::vector<KPoint> &points, double qx, double qy)
+    {
         KPlane plane(0, 0, 1, 0);
         if (points.empty()) // early exit
             return plane;
-        // store resulting CH into a triagnulated mesh structure
-        Surface_mesh convex_mesh;
-        // return plane;
-
-        // std::vector<KPoint> points(inpoints.size());
-        // std::copy(inpoints.begin(), inpoints.end(), back_inserter(points));
-
-        // TODO: debug with pwd: /media/cappelletto/ssd480/experiments/LAD_Test/convex_hull
-        // mad_test --config=../config.yaml --input=../Koyo-18/0181-Clip12x12/input/ky18181_clip_12x12m.tif --rotation=0 --slope_algorithm=1
-        // cout << "p.size(): " << points.size() << endl;
-        // cout << endl << "Data: ";
-        // for (auto _p:points){
-        //     cout << " " << _p ;
-        // }
-        // #pragma omp critical
+        // store resulting CH into a triangulated mesh structure, reused by every pixel evaluated by this thread
+        static thread_local Surface_mesh convex_mesh;
+        convex_mesh.clear();
         CGAL::convex_hull_3(points.begin(), points.end(), convex_mesh); // compute CH from input pointcloud, stores as mesh
 
-        // Step 5: Dump CH information
-        // cout << "Resulting convex hull: " << endl;
-        // cout << "# edges: "     << convex_mesh.num_edges() << endl;
-        // cout << "# faces: "     << convex_mesh.num_faces() << endl;
-        // cout << "# vertices: "  << convex_mesh.num_vertices() << endl;
-        // return plane;
+        // Scan the facets crossed by the vertical line through (qx, qy). A vertical ray cast from above would hit first
+        // the highest of them. A closed hull is crossed at least twice, less than 2 hits means it is degenerated
+        int n_int = 0;
+        double zTop = 0;
+        KPoint top[3];
+        for (auto fid : convex_mesh.faces())
+        {
+            CGAL::Vertex_around_face_circulator<Surface_mesh> vcirc(convex_mesh.halfedge(fid), convex_mesh);
+            KPoint v[3];
+            v[0] = convex_mesh.point(*vcirc++);
+            v[1] = convex_mesh.point(*vcirc++);
+            v[2] = convex_mesh.point(*vcirc++);
+            double area = orientation2D(v[0].x(), v[0].y(), v[1].x(), v[1].y(), v[2].x(), v[2].y());
+            if (fabs(area) < 1e-300) // vertical facet
+                continue;
+            // barycentric coordinates of the query point in the XY projection of the facet
+            double l0 = orientation2D(qx, qy, v[1].x(), v[1].y(), v[2].x(), v[2].y()) / area;
+            double l1 = orientation2D(v[0].x(), v[0].y(), qx, qy, v[2].x(), v[2].y()) / area;
+            double l2 = 1.0 - l0 - l1;
+            if (l0 < 0 || l1 < 0 || l2 < 0)
+                continue;
+            double z = l0 * v[0].z() + l1 * v[1].z() + l2 * v[2].z();
+            if (n_int == 0 || z > zTop)
+            {
+                zTop = z;
+                top[0] = v[0];
+                top[1] = v[1];
+                top[2] = v[2];
+            }
+            n_int++;
+        }
+        if (n_int < 2)
+        {
+            KPlane error_plane(1, 0, 0, 0); // a vertical plane as an error flag
+            return error_plane;             // WARNING: this should produce a 90 degree angle (slope) estimation
+        }
+        // we build a constructed copy of the triangular face as plane
+        plane = KPlane(top[0], top[1], top[2]);
+        return plane;
+    }
 
-        // cout << "Data:" << endl;
-        // for (auto v:convex_mesh.vertices()){
-        //     cout << v << ": " << convex_mesh.point(v) << " || ";
-        // }
+    /**
+     * @brief Former implementation of computeConvexHullPlaneCGAL: a new hull mesh and an AABB tree are built for every
+     * call, and the facet above the query point is located with a vertical ray. Only kept as baseline of hull_bench
+     *
+     * @param points Vector of 3D points, relative to the center of the window
+     * @param qx Query point X coordinate
+     * @param qy Query point Y coordinate
+     * @return KPlane CGAL plane described as a 4D vector: A.X + B.Y + C.Z + D = 0
+     */
+    KPlane computeConvexHullPlaneAABB(const std::vector<KPoint> &points, double qx, double qy)
+    {
+        KPlane plane(0, 0, 1, 0);
+        if (points.empty()) // early exit
+            return plane;
+        Surface_mesh convex_mesh;
+        CGAL::convex_hull_3(points.begin(), points.end(), convex_mesh); // compute CH from input pointcloud, stores as mesh
 
-        // Step 6: Construct AABB tree from CH
-        // constructs AABB tree and computes internal KD-tree
         CGAL::AABB_tree<AABB_face_graph_traits> tree; // data structure to accelerate distance queries
         PMP::build_AABB_tree(convex_mesh, tree);      // build AABB tree from triangulated surface mesh
 
-        // Step 9: Create Ray for intersection
-        // TODO: user pixel resolution information to enforce numerical stability when interecting with the "center"
-        // TODO: also, min-max distance may affect ray intersection when operating as segment (it shouldn't)
-        KPoint pointA(0.0001, 0.0001, 1000.0);
-        KPoint pointB(0.0001, 0.0001, -1000.0);
+        KPoint pointA(qx, qy, 1000.0);
+        KPoint pointB(qx, qy, -1000.0);
         Ray ray(pointA, pointB);
-
-        // BP HERE
-
-        // Step 9.1: Optional facet intersection check
-        // TODO: use returned value, we should expect 2 hits, if none, the obtained convexhull is degenerated (raise exception)
         int n_int = tree.number_of_intersected_primitives(ray);
-        // std::cout << n_int << " intersections(s) with ray query" << std::endl;
         if (n_int < 2)
         {
-            // std::cout << "WARNING: convex hull is degenerated, no intersection with ray query" << std::endl;
-            // std::cout << "Total intersections found: " << n_int << std::endl;
             KPlane error_plane(1, 0, 0, 0); // a vertical plane as an error flag
-            return error_plane;             // WARNING: this should produce a 90 degree angle (slope) estimation
+            return error_plane;
         }
-
-        // Step 10: Locate intersected face (if any) and intersection point
-        // check: https://doc.cgal.org/latest/Polygon_mesh_processing/Polygon_mesh_processing_2locate_example_8cpp-example.html#a11
         Face_location ray_location = PMP::locate_with_AABB_tree(ray, tree, convex_mesh);
-        //        std::cout << "Ray intersection in face <" << ray_location.first
-        //   << "> with barycentric coords [" << ray_location.second[0] << " "
-        //                                    << ray_location.second[1] << " "
-        //                                    << ray_location.second[2] << "]\n";
-        KPoint intersection = PMP::construct_point(ray_location, convex_mesh);
-        // std::cout << "Intersection point (" << intersection << ")\n";
-        // std::cout << "Is it on the face's border? " << (PMP::is_on_face_border(ray_location, convex_mesh) ? "Yes" : "No") << "\n\n";
-
-        auto fid = ray_location.first;
-
-        CGAL::SM_Halfedge_index hid;
-        hid = convex_mesh.halfedge(fid); // gets a halfedge of face f
-        // cout << "Half edge data: " << hid << endl;
-        // int inc = convex_mesh.degree(fid);
-        // cout << "Degree of face: " << inc <<endl;    // it should return 3
-
-        CGAL::Vertex_around_face_circulator<Surface_mesh> vcirc(convex_mesh.halfedge(fid), convex_mesh), done(vcirc);
-        // do{
-        //     cout << "Point for " << *vcirc++ << " || ";
-        //     cout << convex_mesh.point(*vcirc) << endl;
-        // }while (vcirc != done);
-
-        // we build a constructed copy of the triangular face as plane
-        plane = KPlane(convex_mesh.point(*vcirc++), convex_mesh.point(*vcirc++), convex_mesh.point(*vcirc++));
+        CGAL::Vertex_around_face_circulator<Surface_mesh> vcirc(convex_mesh.halfedge(ray_location.first), convex_mesh);
+        KPoint v0 = convex_mesh.point(*vcirc++);
+        KPoint v1 = convex_mesh.point(*vcirc++);
+        KPoint v2 = convex_mesh.point(*vcirc++);
+        plane = KPlane(v0, v1, v2);
         return plane;
     }
 
     /**
-     * @brief
+     * @brief Total least-squares fitting plane of a set of points (CGAL linear_least_squares_fitting_3). This is the fit of
+     * the gathering engine, kept as the reference of the closed-form eigen-solver of the moment engine (see window_check)
      *
      * @param points Vector of 3D points to be fitted in a plane
-     * @return KPlane CGAL plane described as a 4D vector: A.X + B.Y + C.Z + D = 0
+     * @return KPlane CGAL plane described as a 4D vector: A.X + B.Y + C.Z + D = 0, with C >= 0
      */
-    KPlane computeFittingPlane(std::vector<KPoint> points)
+    KPlane computeFittingPlane(const std::vector<KPoint> &points)
     {
         KPlane plane(0, 0, 1, 0);
         if (points.empty()) // early exit
             return plane;
-        // fit plane to whole triangles
         linear_least_squares_fitting_3(points.begin(), points.end(), plane, CGAL::Dimension_tag<0>());
+        if (plane.c() < 0) // keep the normal pointing upwards
+            plane = plane.opposite();
         return plane;
     }
 
+    /**
+     * @brief Least-squares quadric surface z = q0.x^2 + q1.y^2 + q2.xy + q3.x + q4.y + q5 of a set of points (vertical
+     * residuals). Coordinates are centred at the centroid to keep the normal equations well conditioned, the returned
+     * coefficients are expressed in the original coordinates of the points
+     *
+     * @param points Vector of 3D points to be fitted, at least 6
+     * @param q Output array of 6 coefficients [x^2, y^2, xy, x, y, 1]
+     * @return int Error code, if any. ERROR_WRONG_ARGUMENT if there are not enough points, or they are degenerate (e.g. collinear)
+     */
+    int computeFittingQuadric(const std::vector<KPoint> &points, double *q)
+    {
+        for (int i = 0; i < 6; i++)
+            q[i] = 0;
+        if (points.size() < 6)
+            return ERROR_WRONG_ARGUMENT;
+        double cx = 0, cy = 0, cz = 0;
+        for (const auto &p : points)
+        {
+            cx += p.x();
+            cy += p.y();
+            cz += p.z();
+        }
+        double in = 1.0 / points.size();
+        cx *= in;
+        cy *= in;
+        cz *= in;
+        cv::Matx66d A = cv::Matx66d::zeros();
+        cv::Vec6d b = cv::Vec6d::all(0);
+        for (const auto &p : points)
+        {
+            double x = p.x() - cx;
+            double y = p.y() - cy;
+            cv::Vec6d u(x * x, y * y, x * y, x, y, 1);
+            double z = p.z() - cz;
+            for (int i = 0; i < 6; i++)
+            {
+                b[i] += u[i] * z;
+                for (int j = i; j < 6; j++)
+                    A(i, j) += u[i] * u[j];
+            }
+        }
+        for (int i = 0; i < 6; i++) // symmetric normal equations, only the upper half was accumulated
+            for (int j = 0; j < i; j++)
+                A(i, j) = A(j, i);
+        cv::Vec6d s;
+        if (!cv::solve(A, b, s, cv::DECOMP_CHOLESKY))
+            return ERROR_WRONG_ARGUMENT;
+        // back to the original coordinates: x = x' + cx, y = y' + cy
+        q[0] = s[0];
+        q[1] = s[1];
+        q[2] = s[2];
+        q[3] = s[3] - 2 * s[0] * cx - s[2] * cy;
+        q[4] = s[4] - 2 * s[1] * cy - s[2] * cx;
+        q[5] = s[5] + cz + s[0] * cx * cx + s[1] * cy * cy + s[2] * cx * cy - s[3] * cx - s[4] * cy;
+        return NO_ERROR;
+    }
+
     /**
      * @brief Converts vector of 2D points from one coordinate space to another. The valid spaces are PIXEL and WORLD coordinates
      *
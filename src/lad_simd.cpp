@@ -0,0 +1,161 @@
+/**
+ * @file lad_simd.cpp
+ * @author Jose Cappelletto (cappelletto@gmail.com)
+ * @brief Runtime (CPUID) dispatch of the SIMD kernels, and their portable (scalar) build
+ * @version 0.1
+ * @date 2024-03-18
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "lad_simd.hpp"
+#include "lad_simd_kernels.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <strings.h>
+
+namespace lad
+{
+    namespace
+    {
+        // the scalar eigen-solver of the caller handles every matrix
+        int computeVerticalComponentsScalar(const double *const *, int, double *)
+        {
+            return 0;
+        }
+
+        const SimdKernels scalarKernels = {ISA_SCALAR, 1,
+                                           computeVerticalComponentsScalar,
+                                           computeSensorScoreKernel<double>,
+                                           computeSensorScoreKernel<float>};
+
+        std::atomic<const SimdKernels *> selectedKernels{nullptr};
+        std::once_flag detectedKernels; // first use without setSimdIsa
+
+        const SimdKernels *getIsaKernels(int isa)
+        {
+            switch (isa)
+            {
+            case ISA_AVX512:
+                return getSimdKernelsAVX512();
+            case ISA_AVX2:
+                return getSimdKernelsAVX2();
+            case ISA_SSE42:
+                return getSimdKernelsSSE42();
+            default:
+                return &scalarKernels;
+            }
+        }
+
+        // instruction sets reported by CPUID
+        bool isCpuSupported(int isa)
+        {
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+            __builtin_cpu_init();
+            switch (isa)
+            {
+            case ISA_AVX512:
+                return __builtin_cpu_supports("avx512f");
+            case ISA_AVX2:
+                return __builtin_cpu_supports("avx2");
+            case ISA_SSE42:
+                return __builtin_cpu_supports("sse4.2");
+            default:
+                return true;
+            }
+#else
+            return isa == ISA_SCALAR;
+#endif
+        }
+    }
+
+    /**
+     * @brief Best instruction set supported by the CPU for which the kernels were built
+     *
+     * @return int Instruction set (SimdIsa)
+     */
+    int detectSimdIsa()
+    {
+        for (int isa = ISA_AVX512; isa > ISA_SCALAR; isa--)
+            if (isCpuSupported(isa) && getIsaKernels(isa) != nullptr)
+                return isa;
+        return ISA_SCALAR;
+    }
+
+    /**
+     * @brief Select the kernels used by the sliding window engine. A forced instruction set is lowered to the best
+     * available one when the CPU (or the build) does not support it. It must be called before spawning worker threads
+     *
+     * @param isa Requested instruction set (SimdIsa), ISA_AUTO to detect it
+     * @return int Selected instruction set
+     */
+    int setSimdIsa(int isa)
+    {
+        int best = detectSimdIsa();
+        if (isa == ISA_AUTO || isa > best)
+            isa = best;
+        // a lower instruction set may still be missing from the build (e.g. SSE4.2 with an AVX-512 only compiler setup)
+        while (isa > ISA_SCALAR && getIsaKernels(isa) == nullptr)
+            isa--;
+        selectedKernels.store(getIsaKernels(isa), std::memory_order_release);
+        return isa;
+    }
+
+    /**
+     * @brief Kernels currently selected. The instruction set is detected on first use if setSimdIsa was never called
+     *
+     * @return const SimdKernels& Table of kernels
+     */
+    const SimdKernels &getSimdKernels()
+    {
+        const SimdKernels *kernels = selectedKernels.load(std::memory_order_acquire);
+        if (kernels == nullptr)
+        {
+            std::call_once(detectedKernels, []()
+                           {
+                               if (selectedKernels.load(std::memory_order_acquire) == nullptr)
+                                   setSimdIsa(ISA_AUTO);
+                           });
+            kernels = selectedKernels.load(std::memory_order_acquire);
+        }
+        return *kernels;
+    }
+
+    /**
+     * @brief Printable name of an instruction set
+     *
+     */
+    const char *getSimdIsaName(int isa)
+    {
+        switch (isa)
+        {
+        case ISA_AUTO:
+            return "AUTO";
+        case ISA_SCALAR:
+            return "SCALAR";
+        case ISA_SSE42:
+            return "SSE42";
+        case ISA_AVX2:
+            return "AVX2";
+        case ISA_AVX512:
+            return "AVX512";
+        default:
+            return "UNKNOWN";
+        }
+    }
+
+    /**
+     * @brief Instruction set from its name, case insensitive
+     *
+     * @param name One of AUTO | SCALAR | SSE42 | AVX2 | AVX512
+     * @return int Instruction set (SimdIsa), -2 if the name is unknown
+     */
+    int parseSimdIsa(const char *name)
+    {
+        for (int isa = ISA_AUTO; isa <= ISA_AVX512; isa++)
+            if (strcasecmp(name, getSimdIsaName(isa)) == 0)
+                return isa;
+        return -2;
+    }
+}
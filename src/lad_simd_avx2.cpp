@@ -0,0 +1,69 @@
+/**
+ * @file lad_simd_avx2.cpp
+ * @author Jose Cappelletto (cappelletto@gmail.com)
+ * @brief AVX2 build of the SIMD kernels (compiled with -mavx2), see lad_simd.hpp
+ * @version 0.1
+ * @date 2024-03-18
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "lad_simd.hpp"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+
+namespace lad
+{
+    namespace
+    {
+        // Thin wrapper around the AVX2 intrinsics, 4 lanes of double precision
+        struct LaneAVX2
+        {
+            typedef __m256d T;
+            typedef __m256d M;
+            enum { W = 4 };
+            static inline T load(const double *p) { return _mm256_loadu_pd(p); }
+            static inline void store(double *p, T a) { _mm256_storeu_pd(p, a); }
+            static inline T set1(double a) { return _mm256_set1_pd(a); }
+            static inline T add(T a, T b) { return _mm256_add_pd(a, b); }
+            static inline T sub(T a, T b) { return _mm256_sub_pd(a, b); }
+            static inline T mul(T a, T b) { return _mm256_mul_pd(a, b); }
+            static inline T div(T a, T b) { return _mm256_div_pd(a, b); }
+            static inline T sqrt(T a) { return _mm256_sqrt_pd(a); }
+            static inline T min(T a, T b) { return _mm256_min_pd(a, b); }
+            static inline T max(T a, T b) { return _mm256_max_pd(a, b); }
+            static inline T abs(T a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+            static inline M gt(T a, T b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+            static inline M le(T a, T b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+            static inline M lor(M a, M b) { return _mm256_or_pd(a, b); }
+            static inline T select(M m, T a, T b) { return _mm256_blendv_pd(a, b, m); } // m ? b : a
+        };
+    }
+}
+
+#include "lad_simd_kernels.hpp"
+
+namespace lad
+{
+    const SimdKernels *getSimdKernelsAVX2()
+    {
+        static const SimdKernels kernels = {ISA_AVX2, LaneAVX2::W,
+                                            computeVerticalComponents<LaneAVX2>,
+                                            computeSensorScoreKernel<double>,
+                                            computeSensorScoreKernel<float>};
+        return &kernels;
+    }
+}
+
+#else
+
+namespace lad
+{
+    const SimdKernels *getSimdKernelsAVX2()
+    {
+        return nullptr;
+    }
+}
+
+#endif
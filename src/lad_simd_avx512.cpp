@@ -0,0 +1,69 @@
+/**
+ * @file lad_simd_avx512.cpp
+ * @author Jose Cappelletto (cappelletto@gmail.com)
+ * @brief AVX-512F build of the SIMD kernels (compiled with -mavx512f), see lad_simd.hpp
+ * @version 0.1
+ * @date 2024-03-18
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "lad_simd.hpp"
+
+#ifdef __AVX512F__
+#include <immintrin.h>
+
+namespace lad
+{
+    namespace
+    {
+        // Thin wrapper around the AVX-512F intrinsics, 8 lanes of double precision
+        struct LaneAVX512
+        {
+            typedef __m512d T;
+            typedef __mmask8 M;
+            enum { W = 8 };
+            static inline T load(const double *p) { return _mm512_loadu_pd(p); }
+            static inline void store(double *p, T a) { _mm512_storeu_pd(p, a); }
+            static inline T set1(double a) { return _mm512_set1_pd(a); }
+            static inline T add(T a, T b) { return _mm512_add_pd(a, b); }
+            static inline T sub(T a, T b) { return _mm512_sub_pd(a, b); }
+            static inline T mul(T a, T b) { return _mm512_mul_pd(a, b); }
+            static inline T div(T a, T b) { return _mm512_div_pd(a, b); }
+            static inline T sqrt(T a) { return _mm512_sqrt_pd(a); }
+            static inline T min(T a, T b) { return _mm512_min_pd(a, b); }
+            static inline T max(T a, T b) { return _mm512_max_pd(a, b); }
+            static inline T abs(T a) { return _mm512_abs_pd(a); }
+            static inline M gt(T a, T b) { return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ); }
+            static inline M le(T a, T b) { return _mm512_cmp_pd_mask(a, b, _CMP_LE_OQ); }
+            static inline M lor(M a, M b) { return a | b; }
+            static inline T select(M m, T a, T b) { return _mm512_mask_blend_pd(m, a, b); } // m ? b : a
+        };
+    }
+}
+
+#include "lad_simd_kernels.hpp"
+
+namespace lad
+{
+    const SimdKernels *getSimdKernelsAVX512()
+    {
+        static const SimdKernels kernels = {ISA_AVX512, LaneAVX512::W,
+                                            computeVerticalComponents<LaneAVX512>,
+                                            computeSensorScoreKernel<double>,
+                                            computeSensorScoreKernel<float>};
+        return &kernels;
+    }
+}
+
+#else
+
+namespace lad
+{
+    const SimdKernels *getSimdKernelsAVX512()
+    {
+        return nullptr;
+    }
+}
+
+#endif
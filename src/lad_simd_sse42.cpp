@@ -0,0 +1,69 @@
+/**
+ * @file lad_simd_sse42.cpp
+ * @author Jose Cappelletto (cappelletto@gmail.com)
+ * @brief SSE4.2 build of the SIMD kernels (compiled with -msse4.2), see lad_simd.hpp
+ * @version 0.1
+ * @date 2024-03-18
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "lad_simd.hpp"
+
+#ifdef __SSE4_2__
+#include <immintrin.h>
+
+namespace lad
+{
+    namespace
+    {
+        // Thin wrapper around the SSE4.2 intrinsics, 2 lanes of double precision
+        struct LaneSSE42
+        {
+            typedef __m128d T;
+            typedef __m128d M;
+            enum { W = 2 };
+            static inline T load(const double *p) { return _mm_loadu_pd(p); }
+            static inline void store(double *p, T a) { _mm_storeu_pd(p, a); }
+            static inline T set1(double a) { return _mm_set1_pd(a); }
+            static inline T add(T a, T b) { return _mm_add_pd(a, b); }
+            static inline T sub(T a, T b) { return _mm_sub_pd(a, b); }
+            static inline T mul(T a, T b) { return _mm_mul_pd(a, b); }
+            static inline T div(T a, T b) { return _mm_div_pd(a, b); }
+            static inline T sqrt(T a) { return _mm_sqrt_pd(a); }
+            static inline T min(T a, T b) { return _mm_min_pd(a, b); }
+            static inline T max(T a, T b) { return _mm_max_pd(a, b); }
+            static inline T abs(T a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+            static inline M gt(T a, T b) { return _mm_cmpgt_pd(a, b); }
+            static inline M le(T a, T b) { return _mm_cmple_pd(a, b); }
+            static inline M lor(M a, M b) { return _mm_or_pd(a, b); }
+            static inline T select(M m, T a, T b) { return _mm_blendv_pd(a, b, m); } // m ? b : a
+        };
+    }
+}
+
+#include "lad_simd_kernels.hpp"
+
+namespace lad
+{
+    const SimdKernels *getSimdKernelsSSE42()
+    {
+        static const SimdKernels kernels = {ISA_SSE42, LaneSSE42::W,
+                                            computeVerticalComponents<LaneSSE42>,
+                                            computeSensorScoreKernel<double>,
+                                            computeSensorScoreKernel<float>};
+        return &kernels;
+    }
+}
+
+#else
+
+namespace lad
+{
+    const SimdKernels *getSimdKernelsSSE42()
+    {
+        return nullptr;
+    }
+}
+
+#endif
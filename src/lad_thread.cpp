@@ -27,7 +27,9 @@ int lad::processRotationWorker(lad::Pipeline *ap, parameterStruct *p)
         s << "Creating KernelAUV" << suffix;
         logc.debug("prW", s);
     }
-    ap->createKernelTemplate("KernelAUV" + suffix, params.robotWidth, params.robotLength, cv::MORPH_RECT);
+    // the kernel may have been already created by the heading-batched slope pre-pass
+    if (ap->isAvailable("KernelAUV" + suffix))
+        ap->createKernelTemplate("KernelAUV" + suffix, params.robotWidth, params.robotLength, cv::MORPH_RECT);
     auto ptrLayer = dynamic_pointer_cast<KernelLayer>(ap->getLayer("KernelAUV" + suffix));
     if (ptrLayer == nullptr)
     {
@@ -45,12 +47,18 @@ int lad::processRotationWorker(lad::Pipeline *ap, parameterStruct *p)
     //     logc.info("pRW", s);
     // }
 
-    std::thread threadLaneC(&lad::processLaneC, ap, &params, suffix);
     if (p->verbosity > 0)
     {
-        s << "Lane C dispatched for orientation [" << blue << currRotation << reset << "] degrees";
+        s << "Lane " << (params.measurability ? "CX" : "C") << " dispatched for orientation [" << blue << currRotation << reset << "] degrees";
         logc.info("pRW", s);
     }
+    // the lane runs on the calling thread: from the heading loop of land.cpp, the tiles of its window filters are shared
+    // with the OpenMP team of the loop (see forEachWindowTile), instead of a new team per heading.
+    // With the measurability maps, lanes C & X share the points and plane of every window (see processLaneCX)
+    if (params.measurability)
+        lad::processLaneCX(ap, &params, suffix);
+    else
+        lad::processLaneC(ap, &params, suffix);
 
     // std::thread threadLaneX (&lad::processLaneX, ap, &params, suffix);
     // if (p->verbosity>0){
@@ -61,9 +69,8 @@ int lad::processRotationWorker(lad::Pipeline *ap, parameterStruct *p)
     // WARNING C+D+X is the right order. Do not try to reorder (as vtun suggested for thread locking improvement).
     // Data flow imposes this
 
-    threadLaneC.join();
     // threadLaneD.join();
-    s << "Lane [C] done for orientation [" << green << currRotation << reset << "] degrees";
+    s << "Lane [" << (params.measurability ? "CX" : "C") << "] done for orientation [" << green << currRotation << reset << "] degrees";
     // s << "Lane C & D done for orientation [" << green << currRotation << reset << "] degrees";
     logc.info("pRW", s);
     // ap->computeLandabilityMap ("C3_MeanSlopeExcl" + suffix, "D2_LoProtExcl" + suffix, "D4_HiProtExcl" + suffix, "M3_LandabilityMap" + suffix);
@@ -90,15 +97,19 @@ int lad::processRotationWorker(lad::Pipeline *ap, parameterStruct *p)
     // The new Landability Map is just a copy of the MeanSlopeExcl map
 
     ap->copyMask("C1_ExclusionMap", "M3_LandabilityMap" + suffix);
-    // ap->computeBlendMeasurability("M3_LandabilityMap" + suffix, "X1_MeasurabilityMap" + suffix, "M4_FinalMeasurability" + suffix);
+    if (params.measurability)
+        ap->computeBlendMeasurability("M3_LandabilityMap" + suffix, "X1_MeasurabilityMap" + suffix, "M4_FinalMeasurability" + suffix);
 
     // here we should ask if we need to export every intermediate layer (rotated)
     if (p->exportRotated)
     {
         ap->saveImage("M3_LandabilityMap" + suffix, "M3_LandabilityMap" + suffix + ".png");
         ap->exportLayer("M3_LandabilityMap" + suffix, "M3_LandabilityMap" + suffix + ".tif", FMT_TIFF, WORLD_COORDINATE);
-        // ap->saveImage("M4_FinalMeasurability" + suffix, "M4_FinalMeasurability" + suffix + ".png");
-        // ap->exportLayer("M4_FinalMeasurability" + suffix, "M4_FinalMeasurability" + suffix + ".tif", FMT_TIFF, WORLD_COORDINATE);
+        if (params.measurability)
+        {
+            ap->saveImage("M4_FinalMeasurability" + suffix, "M4_FinalMeasurability" + suffix + ".png");
+            ap->exportLayer("M4_FinalMeasurability" + suffix, "M4_FinalMeasurability" + suffix + ".tif", FMT_TIFF, WORLD_COORDINATE);
+        }
     }
     return NO_ERROR;
 }
@@ -111,7 +122,9 @@ int lad::processRotationWorker(lad::Pipeline *ap, parameterStruct *p, std::strin
 
     int nRot = (params.rotationMax - params.rotationMin) / params.rotationStep;
 
-#pragma omp for nowait
+    // the three phases share the static schedule: every heading runs its lanes on the same thread, in order, so lane D
+    // (cheap) has produced the exclusions of the heading before its lanes C & X (expensive) are gated by them
+#pragma omp for schedule(static) nowait
     for (int r = 0; r <= nRot; r++)
     {
         std::ostringstream s;
@@ -142,7 +155,10 @@ int lad::processRotationWorker(lad::Pipeline *ap, parameterStruct *p, std::strin
 
     cout << "PHASE 2" << endl;
 
-#pragma omp for nowait
+    // least-square slope (C) and measurability (X) share the points and plane of every window: one fused pass for both
+    bool fusedCX = (params.slopeAlgorithm == lad::FilterType::FILTER_SLOPE);
+
+#pragma omp for schedule(static) nowait
     for (int r = 0; r <= nRot; r++)
     {
         std::ostringstream s;
@@ -155,14 +171,19 @@ int lad::processRotationWorker(lad::Pipeline *ap, parameterStruct *p, std::strin
         // dynamic_pointer_cast<KernelLayer>(ap->getLayer("KernelAUV" + suffix))->setRotation(currRotation);
         // compute the rotation dependent layers
         // C3_MeanSlopeExcl
-        lad::processLaneC(ap, &params, suffix);
+        if (fusedCX)
+            lad::processLaneCX(ap, &params, suffix);
+        else
+            lad::processLaneC(ap, &params, suffix);
         // std::thread threadLaneC (&lad::processLaneC, ap, &params, suffix);
         // threadLaneC.join();
     }
 
-#pragma omp for nowait
+#pragma omp for schedule(static) nowait
     for (int r = 0; r <= nRot; r++)
     {
+        if (fusedCX)
+            continue; // X1_MeasurabilityMap was already produced by the fused lane C
         std::ostringstream s;
         double currRotation = params.rotationMin + r * params.rotationStep;
         s << "Current orientation [" << blue << currRotation << reset << "] degrees" << endl;
@@ -176,7 +197,7 @@ int lad::processRotationWorker(lad::Pipeline *ap, parameterStruct *p, std::strin
     }
 
     logc.info("processRotationWorker", "PHASE 3: ");
-#pragma omp for nowait
+#pragma omp for schedule(static) nowait
     for (int r = 0; r <= nRot; r++)
     {
         double currRotation = params.rotationMin + r * params.rotationStep;
@@ -208,6 +229,34 @@ int lad::processRotationWorker(lad::Pipeline *ap, parameterStruct *p, std::strin
     return NO_ERROR;
 }
 
+/**
+ * @brief Mask passed to the window filters of lanes C & X. With exclusion gating, pixels already excluded by missing
+ * data are not evaluated: the no-data exclusion map (C1_ExclusionMap, valid pixels whose footprint is fully covered by
+ * valid data). The valid data mask otherwise
+ */
+static std::string getWindowMask(lad::Pipeline *ap, parameterStruct *p, std::string suffix)
+{
+    if (p->exclusionGating && !ap->isAvailable("C1_ExclusionMap"))
+        return "C1_ExclusionMap";
+    return "M1_VALID_DataMask";
+}
+
+/**
+ * @brief Flag as excluded the pixels of a binary exclusion layer that were skipped by the exclusion gating, as their
+ * slope was not evaluated (NODATA never compares greater than the threshold)
+ */
+static void excludeGatedPixels(lad::Pipeline *ap, parameterStruct *p, std::string suffix, std::string dst)
+{
+    std::string mask = getWindowMask(ap, p, suffix);
+    if (mask == "M1_VALID_DataMask")
+        return;
+    auto apMask = dynamic_pointer_cast<RasterLayer>(ap->getLayer(mask));
+    auto apDst = dynamic_pointer_cast<RasterLayer>(ap->getLayer(dst));
+    if (apMask == nullptr || apDst == nullptr || apMask->rasterData.size() != apDst->rasterData.size())
+        return;
+    apDst->rasterData.setTo(255, apMask->rasterData == 0);
+}
+
 int lad::processLaneX(lad::Pipeline *ap, parameterStruct *p, std::string suffix)
 {
 
@@ -217,7 +266,7 @@ int lad::processLaneX(lad::Pipeline *ap, parameterStruct *p, std::string suffix)
     // we create an unique name using the rotation angle
     // s << "computeMeasurability -> X1_MeasurabilityMap for " << blue << suffix;
     // logc.debug("laneX", s);
-    ap->computeMeasurabilityMap("M1_RAW_Bathymetry", "KernelAUV" + suffix, "M1_VALID_DataMask", "X1_MeasurabilityMap" + suffix);
+    ap->computeMeasurabilityMap("M1_RAW_Bathymetry", "KernelAUV" + suffix, getWindowMask(ap, p, suffix), "X1_MeasurabilityMap" + suffix);
     // ap->showImage("C2_MeanSlope");
     if (p->exportRotated)
     {
@@ -234,6 +283,52 @@ int lad::processLaneX(lad::Pipeline *ap, parameterStruct *p, std::string suffix)
     return 0;
 }
 
+/**
+ * @brief File of the plane cache holding the plane coefficient layer P1_PlaneMap of a heading. Its name carries the
+ * identity of the bathymetry, the kernel and the plane fitting settings (see Pipeline::getPlaneCacheTag), so planes of
+ * another survey, vehicle or configuration are never picked up
+ */
+static std::string getPlaneCacheFile(lad::Pipeline *ap, parameterStruct *p, std::string suffix)
+{
+    return p->planeCache + "P1_PlaneMap" + suffix + "_" + ap->getPlaneCacheTag("M1_RAW_Bathymetry", "KernelAUV" + suffix) + ".tif";
+}
+
+/**
+ * @brief Read the plane coefficient layer P1_PlaneMap of a heading from the plane cache, if enabled and present
+ *
+ * @return true if the planes were loaded, and will be reused by the window filters of KernelAUV + suffix
+ */
+static bool loadPlaneCache(lad::Pipeline *ap, parameterStruct *p, std::string suffix)
+{
+    if (p->planeCache.empty())
+        return false;
+    std::string file = getPlaneCacheFile(ap, p, suffix);
+    if (!std::ifstream(file).good())
+        return false;
+    return ap->loadPlaneLayer("M1_RAW_Bathymetry", "KernelAUV" + suffix, file, "P1_PlaneMap" + suffix) == NO_ERROR;
+}
+
+int lad::processLaneCX(lad::Pipeline *ap, parameterStruct *p, std::string suffix)
+{
+    // C2_MeanSlope may have been already computed for every heading in a single batched pass (see land.cpp)
+    if (!ap->isAvailable("C2_MeanSlope" + suffix) || p->slopeAlgorithm != lad::FilterType::FILTER_SLOPE)
+    {
+        lad::processLaneC(ap, p, suffix);
+        return lad::processLaneX(ap, p, suffix);
+    }
+
+    lad::tictac tt;
+    tt.start();
+    // missing plane coefficients are computed in the same pass, and stored in the plane cache for the next run
+    std::string plane = (p->planeCache.empty() || loadPlaneCache(ap, p, suffix)) ? "" : "P1_PlaneMap" + suffix;
+    ap->computeSlopeMeasurabilityMap("M1_RAW_Bathymetry", "KernelAUV" + suffix, getWindowMask(ap, p, suffix), "C2_MeanSlope" + suffix, "X1_MeasurabilityMap" + suffix, plane);
+    if (!plane.empty())
+        ap->exportLayer(plane, getPlaneCacheFile(ap, p, suffix), FMT_TIFF, WORLD_COORDINATE);
+    tt.lap("\tLane CX: C2_MeanSlope & X1_Measurability");
+    // lane C picks the precomputed C2_MeanSlope, and exports X1_MeasurabilityMap if requested
+    return lad::processLaneC(ap, p, suffix);
+}
+
 int lad::processLaneD(lad::Pipeline *ap, parameterStruct *p, std::string suffix)
 {
 
@@ -341,7 +436,8 @@ int lad::processLaneD(lad::Pipeline *ap, parameterStruct *p, std::string suffix)
     }
     // now, we create the Exclusion map, for the current vehicle heading (stored in KernelAUV)
     cv::Mat excl(apHiProt->rasterData.size(), CV_8UC1); // same size and type as original mask
-    cv::dilate(apHiProt->rasterData, excl, auvKernel->rotatedData);
+    if (dilateMask(apHiProt->rasterData, auvKernel->bank.shape, excl) != NO_ERROR)
+        cv::dilate(apHiProt->rasterData, excl, auvKernel->rotatedData);
     ap->createLayer("D4_HiProtExcl" + suffix, LAYER_RASTER);
 
     // s << "Created D4_HiProtExcl " << suffix;
@@ -402,11 +498,32 @@ int lad::processLaneC(lad::Pipeline *ap, parameterStruct *p, std::string suffix)
     // logc.debug("laneC", s);
     // we create an unique name using the rotation angle
 
-    if (p->slopeAlgorithm == lad::FilterType::FILTER_SLOPE)
-        ap->computeMeanSlopeMap("M1_RAW_Bathymetry", "KernelAUV" + suffix, "M1_VALID_DataMask", "C2_MeanSlope" + suffix);
+    // C2_MeanSlope may have been already computed for every heading in a single batched pass (see land.cpp)
+    if (!ap->isAvailable("C2_MeanSlope" + suffix))
+    {
+        if (ap->verbosity > 1)
+        {
+            s << "Reusing batched C2_MeanSlope" << suffix;
+            logc.debug("laneC", s);
+        }
+    }
+    else if (p->slopeAlgorithm == lad::FilterType::FILTER_SLOPE)
+    {
+        // with a plane cache, the slope is evaluated from the stored plane coefficients
+        if (!p->planeCache.empty() && !loadPlaneCache(ap, p, suffix))
+        {
+            ap->computePlaneLayer("M1_RAW_Bathymetry", "KernelAUV" + suffix, "M1_VALID_DataMask", "P1_PlaneMap" + suffix);
+            ap->exportLayer("P1_PlaneMap" + suffix, getPlaneCacheFile(ap, p, suffix), FMT_TIFF, WORLD_COORDINATE);
+        }
+        ap->computeMeanSlopeMap("M1_RAW_Bathymetry", "KernelAUV" + suffix, getWindowMask(ap, p, suffix), "C2_MeanSlope" + suffix);
+    }
     else if (p->slopeAlgorithm == lad::FilterType::FILTER_CONVEX_SLOPE)
     {
-        ap->computeConvexSlopeMap("M1_RAW_Bathymetry", "KernelAUV" + suffix, "M1_VALID_DataMask", "C2_MeanSlope" + suffix);
+        // with screening, windows clearly below the threshold hold an upper bound of their hull slope (see computeSlopeScreen)
+        if (p->slopeScreening > 0)
+            ap->computeScreenedSlopeMap("M1_RAW_Bathymetry", "KernelAUV" + suffix, getWindowMask(ap, p, suffix), "C2_MeanSlope" + suffix, p->slopeAlgorithm, p->slopeThreshold);
+        else
+            ap->computeConvexSlopeMap("M1_RAW_Bathymetry", "KernelAUV" + suffix, getWindowMask(ap, p, suffix), "C2_MeanSlope" + suffix);
         cout << "Lane C: Using CHull algo" << endl;
     }
 
@@ -418,6 +535,7 @@ int lad::processLaneC(lad::Pipeline *ap, parameterStruct *p, std::string suffix)
     }
     logc.debug("laneC", "compareLayer -> C2_MeanSlopeExcl");
     ap->compareLayer("C2_MeanSlope" + suffix, "C3_MeanSlopeExcl" + suffix, p->slopeThreshold, CMP_GT);
+    excludeGatedPixels(ap, p, suffix, "C3_MeanSlopeExcl" + suffix);
     // ap->showImage("C3_MeanSlopeExcl");
     if (p->exportRotated)
     {
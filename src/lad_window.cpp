@@ -0,0 +1,2081 @@
+/**
+ * @file lad_window.cpp
+ * @author Jose Cappelletto (cappelletto@gmail.com)
+ * @brief  Sliding window engine of the Landing Area Detection (lad) algorithm
+ * @version 0.1
+ * @date 2024-03-18
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "lad_window.hpp"
+#include "lad_processing.hpp"
+#include "lad_simd.hpp"
+
+namespace lad
+{
+
+    /**
+     * @brief Extract the horizontal runs of active (non-zero) pixels of a binary kernel
+     *
+     * @param kernel Binary kernel (8UC1), typically the rotated footprint of a KernelLayer
+     * @param aRow Anchor row. Span offsets are expressed relative to it
+     * @param aCol Anchor column. Span offsets are expressed relative to it
+     * @return int Number of extracted spans
+     */
+    int KernelFootprint::build(const cv::Mat &kernel, int aRow, int aCol)
+    {
+        spans.clear();
+        anchorRow = aRow;
+        anchorCol = aCol;
+        nPixels = 0;
+        stride = 0;
+        int minDy = INT_MAX, maxDy = INT_MIN, minDx = INT_MAX, maxDx = INT_MIN;
+        for (int r = 0; r < kernel.rows; r++)
+        {
+            const uchar *p = kernel.ptr<uchar>(r);
+            int c = 0;
+            while (c < kernel.cols)
+            {
+                while (c < kernel.cols && !p[c])
+                    c++;
+                if (c >= kernel.cols)
+                    break;
+                int start = c;
+                while (c < kernel.cols && p[c])
+                    c++;
+                spans.push_back({r - aRow, start - aCol, c - aCol, 0});
+                nPixels += c - start;
+                minDy = std::min(minDy, r - aRow);
+                maxDy = std::max(maxDy, r - aRow);
+                minDx = std::min(minDx, start - aCol);
+                maxDx = std::max(maxDx, c - aCol);
+            }
+        }
+        if (spans.empty())
+            bbox = cv::Rect(0, 0, 0, 0);
+        else
+            bbox = cv::Rect(minDx, minDy, maxDx - minDx, maxDy - minDy + 1);
+        return spans.size();
+    }
+
+    /**
+     * @brief Update the linear offset of every span, so a span can be reached from the anchor position of any raster
+     * sharing the same row stride
+     *
+     * @param newStride Row stride of the target raster, in elements (cv::Mat::step1)
+     * @param newMargin Readable margin [px] around the target raster, see getRasterHalo
+     */
+    void KernelFootprint::setStride(int newStride, int newMargin)
+    {
+        stride = newStride;
+        margin = newMargin;
+        for (auto &s : spans)
+            s.offset = s.dy * stride + s.x0;
+    }
+
+    /**
+     * @brief Deterministic stratified subsample of the footprint: the plane is covered by a grid of step x step cells
+     * aligned with the anchor, and only the pixel at the anchor-aligned corner of every cell is kept. The step is the
+     * smallest one that leaves at most ~budget pixels, so the samples stay evenly spread over the whole footprint and
+     * every window sees the same pattern. The bounding box of the source footprint is kept
+     *
+     * @param budget Target number of pixels of the subsampled footprint
+     * @param dst Subsampled footprint, with the same anchor, stride and margin. A plain copy if budget is not exceeded
+     * @return int Grid step [px], 1 if no subsampling was required
+     */
+    int KernelFootprint::subsample(int budget, KernelFootprint &dst) const
+    {
+        dst = *this;
+        if (budget <= 0 || nPixels <= budget)
+            return 1;
+        int step = (int)ceil(sqrt((double)nPixels / budget));
+        dst.spans.clear();
+        dst.nPixels = 0;
+        for (const auto &s : spans)
+        {
+            if (((s.dy % step) + step) % step) // floor modulo, offsets are negative above/left of the anchor
+                continue;
+            int x = s.x0 + (step - ((s.x0 % step) + step) % step) % step; // first anchor-aligned column of the span
+            for (; x < s.x1; x += step)
+            {
+                dst.spans.push_back({s.dy, x, x + 1, s.dy * stride + x});
+                dst.nPixels++;
+            }
+        }
+        return step;
+    }
+
+    /**
+     * @brief Rebuild the sparse representations of a dense kernel
+     *
+     * @param kernel Dense kernel, typically KernelLayer::rotatedData. Any non-zero pixel is considered part of the footprint
+     * @return int Number of active pixels of the kernel
+     */
+    int KernelBank::build(const cv::Mat &kernel)
+    {
+        cv::Mat bin;
+        kernel.convertTo(bin, CV_8UC1);
+        // applyWindowFilter slides a [-h/2, h/2) x [-w/2, w/2) window, so the last row/column of odd kernels is not used
+        int h2 = bin.rows >> 1;
+        int w2 = bin.cols >> 1;
+        window.build(bin(cv::Range(0, 2 * h2), cv::Range(0, 2 * w2)), h2, w2);
+        // cv::erode/cv::dilate default anchor is the kernel center (cols/2, rows/2)
+        shape.build(bin, bin.rows / 2, bin.cols / 2);
+        return shape.nPixels;
+    }
+
+    /**
+     * @brief Build the row prefix-sum table of the raster moments. Samples equal to NODATA or ZERO are excluded, matching
+     * the convention of the point-cloud extraction (convertMatrix2Vector_Points)
+     *
+     * @param raster Source elevation raster (RASTER_TYPE)
+     * @param nodata No-data value of the raster
+     * @return int Number of valid samples
+     */
+    int MomentTable::build(const cv::Mat &raster, double nodata)
+    {
+        rows = raster.rows;
+        cols = raster.cols;
+        size_t stride = cols + 1;
+        data.assign(rows * stride, RowMoments{0, 0, 0, 0, 0, 0});
+
+        // reference elevation: mean of the valid samples
+        double acum = 0;
+        long count = 0;
+#pragma omp parallel for reduction(+ : acum, count)
+        for (int r = 0; r < rows; r++)
+        {
+            const raster_t *p = raster.ptr<raster_t>(r);
+            for (int c = 0; c < cols; c++)
+            {
+                if (!isNoData(p[c], nodata) && p[c] != 0)
+                {
+                    acum += p[c];
+                    count++;
+                }
+            }
+        }
+        zRef = (count > 0) ? acum / count : 0.0;
+        zScale = 0;
+        qdata.clear();
+
+#pragma omp parallel for schedule(static)
+        for (int r = 0; r < rows; r++)
+        {
+            const raster_t *p = raster.ptr<raster_t>(r);
+            RowMoments *t = &data[r * stride];
+            RowMoments a = t[0];
+            for (int c = 0; c < cols; c++)
+            {
+                if (!isNoData(p[c], nodata) && p[c] != 0)
+                {
+                    double z = p[c] - zRef;
+                    a.n += 1;
+                    a.c += c;
+                    a.cc += (double)c * c;
+                    a.z += z;
+                    a.cz += c * z;
+                    a.zz += z * z;
+                }
+                t[c + 1] = a;
+            }
+        }
+        return count;
+    }
+
+    /**
+     * @brief Build the integer prefix-sum table of a quantised raster, elevation = offset + scale * q. The integer samples
+     * q are recovered from the dequantised elevation, stored relative to an integer reference close to their mean, and
+     * every sum is accumulated in exact int64 arithmetic. The validity rules are those of build (NODATA or ZERO elevation
+     * are excluded)
+     *
+     * @param raster Dequantised elevation raster (RASTER_TYPE), see RasterLayer::quantize
+     * @param nodata No-data value of the raster
+     * @param scale Elevation step [m] of the quantised raster
+     * @param offset Elevation [m] of the quantised value zero
+     * @return int Number of valid samples, or ERROR_WRONG_ARGUMENT if the raster does not fit the integer table (int64)
+     */
+    int MomentTable::buildQuantized(const cv::Mat &raster, double nodata, double scale, double offset)
+    {
+        if (raster.type() != RASTER_TYPE || scale <= 0)
+            return ERROR_WRONG_ARGUMENT;
+        auto quantize = [&](double z) -> int64_t { return std::llround((z - offset) / scale); };
+
+        int64_t acum = 0, count = 0, qmin = INT64_MAX, qmax = INT64_MIN;
+#pragma omp parallel for reduction(+ : acum, count) reduction(min : qmin) reduction(max : qmax)
+        for (int r = 0; r < raster.rows; r++)
+        {
+            const raster_t *p = raster.ptr<raster_t>(r);
+            for (int c = 0; c < raster.cols; c++)
+            {
+                if (!isNoData(p[c], nodata) && p[c] != 0)
+                {
+                    int64_t q = quantize(p[c]);
+                    acum += q;
+                    count++;
+                    qmin = std::min(qmin, q);
+                    qmax = std::max(qmax, q);
+                }
+            }
+        }
+        int64_t qRef = (count > 0) ? (int64_t)std::llround((double)acum / count) : 0;
+        // the largest sums are those of z*z and c*z over a complete table: they must fit in int64
+        double reach = (count > 0) ? std::max(qmax - qRef, qRef - qmin) : 0.0;
+        double cMax = std::max(raster.cols, 1);
+        if (reach * reach * count >= 0x1p62 || reach * cMax * count >= 0x1p62 || cMax * cMax * count >= 0x1p62)
+            return ERROR_WRONG_ARGUMENT;
+
+        rows = raster.rows;
+        cols = raster.cols;
+        zRef = offset + scale * qRef;
+        zScale = scale;
+        data.clear();
+        size_t stride = cols + 1;
+        qdata.assign(rows * stride, RowMomentsQ{0, 0, 0, 0, 0, 0});
+
+#pragma omp parallel for schedule(static)
+        for (int r = 0; r < rows; r++)
+        {
+            const raster_t *p = raster.ptr<raster_t>(r);
+            RowMomentsQ *t = &qdata[r * stride];
+            RowMomentsQ a = t[0];
+            for (int c = 0; c < cols; c++)
+            {
+                if (!isNoData(p[c], nodata) && p[c] != 0)
+                {
+                    int64_t z = quantize(p[c]) - qRef;
+                    a.n += 1;
+                    a.c += c;
+                    a.cc += (int64_t)c * c;
+                    a.z += z;
+                    a.cz += c * z;
+                    a.zz += z * z;
+                }
+                t[c + 1] = a;
+            }
+        }
+        return count;
+    }
+
+    /**
+     * @brief Accumulate the moments of the valid samples covered by a footprint anchored at (row, col). Coordinates are
+     * returned in pixel units relative to the anchor, and elevation relative to zRef
+     *
+     * @param row Anchor row in the raster
+     * @param col Anchor column in the raster
+     * @param footprint Sparse kernel description
+     * @param rowLimit Rows at or beyond this index are ignored (window clipping)
+     * @param colLimit Columns at or beyond this index are ignored (window clipping)
+     * @param m Resulting moments. Previous content is overwritten
+     */
+    void MomentTable::accumulate(int row, int col, const KernelFootprint &footprint, int rowLimit, int colLimit, PlaneMoments &m) const
+    {
+        if (!qdata.empty())
+            return accumulateQuantized(row, col, footprint, rowLimit, colLimit, m);
+        size_t stride = cols + 1;
+        double n = 0, su = 0, suu = 0, sv = 0, svv = 0, suv = 0;
+        double sz = 0, szz = 0, suz = 0, svz = 0;
+        for (const auto &s : footprint.spans)
+        {
+            int r = row + s.dy;
+            if (r < 0 || r >= rowLimit)
+                continue;
+            int c0 = std::max(col + s.x0, 0);
+            int c1 = std::min(col + s.x1, colLimit);
+            if (c1 <= c0)
+                continue;
+            const RowMoments &a = data[r * stride + c0];
+            const RowMoments &b = data[r * stride + c1];
+            double dn = b.n - a.n;
+            if (dn == 0)
+                continue;
+            double dc = b.c - a.c;
+            double dz = b.z - a.z;
+            // shift the column coordinate to the anchor: u = c - col
+            double du = dc - dn * col;
+            double duu = (b.cc - a.cc) - 2.0 * col * dc + dn * col * col;
+            double duz = (b.cz - a.cz) - col * dz;
+            double v = s.dy;
+            n += dn;
+            su += du;
+            suu += duu;
+            sv += dn * v;
+            svv += dn * v * v;
+            suv += v * du;
+            sz += dz;
+            szz += b.zz - a.zz;
+            suz += duz;
+            svz += v * dz;
+        }
+        m.n = n;
+        m.x = su;
+        m.y = sv;
+        m.z = sz;
+        m.xx = suu;
+        m.yy = svv;
+        m.zz = szz;
+        m.xy = suv;
+        m.xz = suz;
+        m.yz = svz;
+    }
+
+    /**
+     * @brief Integer version of accumulate, for tables built by buildQuantized. The moments of the footprint, including
+     * the shift of the column coordinate to the anchor, are exact: the elevation step is only applied to the final sums
+     */
+    void MomentTable::accumulateQuantized(int row, int col, const KernelFootprint &footprint, int rowLimit, int colLimit, PlaneMoments &m) const
+    {
+        size_t stride = cols + 1;
+        int64_t n = 0, su = 0, suu = 0, sv = 0, svv = 0, suv = 0;
+        int64_t sz = 0, szz = 0, suz = 0, svz = 0;
+        for (const auto &s : footprint.spans)
+        {
+            int r = row + s.dy;
+            if (r < 0 || r >= rowLimit)
+                continue;
+            int c0 = std::max(col + s.x0, 0);
+            int c1 = std::min(col + s.x1, colLimit);
+            if (c1 <= c0)
+                continue;
+            const RowMomentsQ &a = qdata[r * stride + c0];
+            const RowMomentsQ &b = qdata[r * stride + c1];
+            int64_t dn = b.n - a.n;
+            if (dn == 0)
+                continue;
+            int64_t dc = b.c - a.c;
+            int64_t dz = b.z - a.z;
+            int64_t du = dc - dn * col;
+            int64_t v = s.dy;
+            n += dn;
+            su += du;
+            suu += (b.cc - a.cc) - 2 * col * dc + dn * col * col;
+            sv += dn * v;
+            svv += dn * v * v;
+            suv += v * du;
+            sz += dz;
+            szz += b.zz - a.zz;
+            suz += (b.cz - a.cz) - col * dz;
+            svz += v * dz;
+        }
+        m.n = n;
+        m.x = su;
+        m.y = sv;
+        m.z = zScale * sz;
+        m.xx = suu;
+        m.yy = svv;
+        m.zz = zScale * zScale * szz;
+        m.xy = suv;
+        m.xz = zScale * suz;
+        m.yz = zScale * svz;
+    }
+
+    /**
+     * @brief Collect the pixels of the sensor circle centered at the anchor. A pixel belongs to the sensor if its center is
+     * strictly closer than diameter/2, the same test applied by gatherFootprintPoints
+     *
+     * @param diameter Diameter [m] of the sensor footprint
+     * @param sx Horizontal pixel scale
+     * @param sy Vertical pixel scale
+     * @param raster Raster the footprint will be applied to. Its stride and halo are used for the linear offsets
+     * @return int Number of pixels of the sensor footprint
+     */
+    int SensorFootprint::build(double diameter, double sx, double sy, const cv::Mat &raster)
+    {
+        dy.clear();
+        dx.clear();
+        x.clear();
+        y.clear();
+        offset.clear();
+        reach = 0;
+        stride = raster.step1();
+        margin = getRasterHalo(raster);
+        if (diameter <= 0 || sx == 0 || sy == 0)
+            return 0;
+        double diam_th = 0.25f * diameter * diameter;
+        int ru = (int)ceil(0.5 * diameter / fabs(sx));
+        int rv = (int)ceil(0.5 * diameter / fabs(sy));
+        for (int v = -rv; v <= rv; v++)
+        {
+            for (int u = -ru; u <= ru; u++)
+            {
+                double px = u * sx;
+                double py = v * sy;
+                if (px * px + py * py >= diam_th)
+                    continue;
+                dy.push_back(v);
+                dx.push_back(u);
+                x.push_back(px);
+                y.push_back(py);
+                offset.push_back((long)v * stride + u);
+                reach = std::max(reach, std::max(abs(u), abs(v)));
+            }
+        }
+        return offset.size();
+    }
+
+    /**
+     * @brief Check that every pixel of the sensor footprint is also part of a kernel footprint. The gathering path only
+     * takes sensor points from the kernel window, so the shared sensor footprint is equivalent only under this condition
+     *
+     * @param footprint Kernel footprint (any heading), anchored at its center
+     * @return true if the sensor is completely covered by the kernel
+     */
+    bool SensorFootprint::isCoveredBy(const KernelFootprint &footprint) const
+    {
+        for (size_t k = 0; k < offset.size(); k++)
+        {
+            bool found = false;
+            for (const auto &s : footprint.spans)
+            {
+                if (s.dy == dy[k] && s.x0 <= dx[k] && dx[k] < s.x1)
+                {
+                    found = true;
+                    break;
+                }
+            }
+            if (!found)
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Width of the NODATA halo that surrounds a raster allocated by RasterLayer::setHalo, i.e. the smallest
+     * margin between the raster and the borders of its parent allocation. Any raster that is not a view of a larger
+     * allocation has no halo. Footprints reaching at most this far outside the raster can be read without clipping
+     *
+     * @param raster Source raster
+     * @return int Halo width [px], zero if none
+     */
+    int getRasterHalo(const cv::Mat &raster)
+    {
+        if (raster.empty())
+            return 0;
+        cv::Size whole;
+        cv::Point ofs;
+        raster.locateROI(whole, ofs);
+        return std::min(std::min(ofs.y, whole.height - raster.rows - ofs.y), std::min(ofs.x, whole.width - raster.cols - ofs.x));
+    }
+
+    /**
+     * @brief Valid data mask of a single-channel raster, following the NODATA rule of isNoData
+     *
+     * @param raster Source raster
+     * @param nodata No-data value of the raster (ignored with USE_NAN_NODATA)
+     * @param mask Output mask (8UC1): 255 for valid samples, 0 for NODATA
+     */
+    void computeValidMask(const cv::Mat &raster, double nodata, cv::Mat &mask)
+    {
+#ifdef USE_NAN_NODATA
+        cv::compare(raster, raster, mask, cv::CMP_EQ); // NaN is the only value that differs from itself
+#else
+        cv::compare(raster, nodata, mask, cv::CMP_NE);
+#endif
+    }
+
+    /**
+     * @brief FNV-1a hash of a block of bytes
+     *
+     * @param data First byte
+     * @param size Number of bytes
+     * @param h Hash of the preceding data, to chain several blocks
+     * @return uint64_t Updated hash
+     */
+    uint64_t hashBytes(const void *data, size_t size, uint64_t h)
+    {
+        const unsigned char *b = (const unsigned char *)data;
+        for (size_t i = 0; i < size; i++)
+            h = (h ^ b[i]) * 0x100000001b3ULL;
+        return h;
+    }
+
+    /**
+     * @brief FNV-1a hash of the samples of a matrix, row by row (the padding of non continuous matrices is skipped),
+     * followed by its size and type
+     *
+     * @param m Source matrix
+     * @param h Hash of the preceding data, to chain several blocks
+     * @return uint64_t Updated hash
+     */
+    uint64_t hashBytes(const cv::Mat &m, uint64_t h)
+    {
+        size_t rowBytes = m.cols * m.elemSize();
+        for (int row = 0; row < m.rows; row++)
+            h = hashBytes(m.ptr(row), rowBytes, h);
+        int shape[3] = {m.rows, m.cols, m.type()};
+        return hashBytes(shape, sizeof(shape), h);
+    }
+
+    /**
+     * @brief Split a nRows x nCols output raster into square tiles of tileSize x tileSize pixels, in row-major order.
+     * Tiles on the bottom and right borders are clipped to the raster. A tile side of 64 px keeps the tile and the halo
+     * of a typical vehicle footprint within the L2 cache, while providing enough tiles to balance a single heading over
+     * many cores
+     *
+     * @param nRows Number of rows of the output raster
+     * @param nCols Number of columns of the output raster
+     * @param tileSize Side [px] of the tiles. Zero or negative to use complete rows (one tile per row)
+     * @param tiles Output list of tiles. Its previous content is discarded
+     * @return int Number of tiles
+     */
+    int buildWindowTiles(int nRows, int nCols, int tileSize, std::vector<WindowTile> &tiles)
+    {
+        tiles.clear();
+        int tileRows = (tileSize > 0) ? tileSize : 1;
+        int tileCols = (tileSize > 0) ? tileSize : std::max(nCols, 1);
+        for (int r = 0; r < nRows; r += tileRows)
+            for (int c = 0; c < nCols; c += tileCols)
+                tiles.push_back({r, std::min(r + tileRows, nRows), c, std::min(c + tileCols, nCols), 0});
+        return tiles.size();
+    }
+
+    /**
+     * @brief Build the index of the valid pixels of a raster: its valid data mask and the runs of valid columns of every row
+     *
+     * @param raster Source elevation raster (RASTER_TYPE)
+     * @param nodata No-data value of the raster
+     * @return int Error code, if any
+     */
+    int ValidIndex::build(const cv::Mat &raster, double nodata)
+    {
+        if (raster.empty() || raster.type() != RASTER_TYPE)
+            return ERROR_WRONG_ARGUMENT;
+        rows = raster.rows;
+        cols = raster.cols;
+        mask.create(rows, cols, CV_8UC1);
+        rowStart.assign(rows + 1, 0);
+        run0.clear();
+        run1.clear();
+        runSum.assign(1, 0);
+        for (int row = 0; row < rows; row++)
+        {
+            const raster_t *src = raster.ptr<raster_t>(row);
+            uchar *valid = mask.ptr<uchar>(row);
+            rowStart[row] = run0.size();
+            for (int col = 0; col < cols; col++)
+            {
+                valid[col] = !isNoData(src[col], nodata) ? 255 : 0;
+                if (!valid[col])
+                    continue;
+                if (run1.size() > (size_t)rowStart[row] && run1.back() == col)
+                    run1.back()++;
+                else
+                {
+                    run0.push_back(col);
+                    run1.push_back(col + 1);
+                    runSum.push_back(runSum.back());
+                }
+                runSum.back()++;
+            }
+        }
+        rowStart[rows] = run0.size();
+        nValid = runSum.back();
+        return NO_ERROR;
+    }
+
+    /**
+     * @brief Number of valid pixels of a row within the columns [col0, col1). Runs are sorted, so only the first and last
+     * runs overlapping the range are clipped
+     *
+     * @param row Row of the raster
+     * @param col0 First column of the range
+     * @param col1 Column past the last column of the range
+     * @return long Number of valid pixels
+     */
+    long ValidIndex::countRow(int row, int col0, int col1) const
+    {
+        auto begin = run1.begin() + rowStart[row];
+        auto end = run1.begin() + rowStart[row + 1];
+        int i = std::upper_bound(begin, end, col0) - run1.begin();                            // first run ending after col0
+        int j = std::lower_bound(run0.begin() + i, run0.begin() + rowStart[row + 1], col1) - run0.begin(); // first run starting at or after col1
+        if (i >= j)
+            return 0;
+        return runSum[j] - runSum[i] - std::max(0, col0 - run0[i]) - std::max(0, run1[j - 1] - col1);
+    }
+
+    /**
+     * @brief Number of valid pixels within the block [row0, row1) x [col0, col1), clipped to the raster
+     *
+     * @return long Number of valid pixels
+     */
+    long ValidIndex::countRect(int row0, int row1, int col0, int col1) const
+    {
+        row0 = std::max(row0, 0);
+        row1 = std::min(row1, rows);
+        col0 = std::max(col0, 0);
+        col1 = std::min(col1, cols);
+        long n = 0;
+        for (int row = row0; row < row1 && col0 < col1; row++)
+            n += countRow(row, col0, col1);
+        return n;
+    }
+
+    /**
+     * @brief Split the raster into tiles as buildWindowTiles, but only over the valid data. Tiles without any valid pixel
+     * are dropped (the window filters leave NODATA anchors untouched) and the others are shrunk to the bounding box of their
+     * valid pixels. The cost of a tile is estimated as its number of valid anchors times the valid density of the area read
+     * by their windows, which is proportional to the number of points gathered. Tiles are sorted by decreasing cost, so the
+     * tasks of the most expensive ones are generated first (longest processing time first) and the cheap tiles of the
+     * swath borders fill the gaps at the end
+     *
+     * @param tileSize Side [px] of the tiles, see buildWindowTiles
+     * @param bbox Bounding box of the window footprint, relative to the anchor
+     * @param tiles Output list of tiles. Its previous content is discarded
+     * @return int Number of tiles
+     */
+    int ValidIndex::planTiles(int tileSize, const cv::Rect &bbox, std::vector<WindowTile> &tiles) const
+    {
+        std::vector<WindowTile> grid;
+        buildWindowTiles(rows, cols, tileSize, grid);
+        tiles.clear();
+        for (auto tile : grid)
+        {
+            // shrink the tile to the rows and columns spanned by its valid pixels
+            int row0 = tile.row1, row1 = tile.row0, col0 = tile.col1, col1 = tile.col0;
+            long n = 0;
+            for (int row = tile.row0; row < tile.row1; row++)
+            {
+                long k = countRow(row, tile.col0, tile.col1);
+                if (!k)
+                    continue;
+                n += k;
+                row0 = std::min(row0, row);
+                row1 = row + 1;
+                auto end = run1.begin() + rowStart[row + 1];
+                int i = std::upper_bound(run1.begin() + rowStart[row], end, tile.col0) - run1.begin();
+                int j = std::lower_bound(run0.begin() + i, run0.begin() + rowStart[row + 1], tile.col1) - run0.begin();
+                col0 = std::min(col0, std::max(tile.col0, run0[i]));
+                col1 = std::max(col1, std::min(tile.col1, run1[j - 1]));
+            }
+            if (!n)
+                continue;
+            // valid density of the area read by the windows anchored in the tile
+            int r0 = row0 + bbox.y, r1 = row1 + bbox.y + bbox.height;
+            int c0 = col0 + bbox.x, c1 = col1 + bbox.x + bbox.width;
+            int height = std::min(r1, rows) - std::max(r0, 0);
+            int width = std::min(c1, cols) - std::max(c0, 0);
+            double density = (height > 0 && width > 0) ? countRect(r0, r1, c0, c1) / ((double)height * width) : 0;
+            tiles.push_back({row0, row1, col0, col1, n * density});
+        }
+        std::stable_sort(tiles.begin(), tiles.end(), [](const WindowTile &a, const WindowTile &b) { return a.cost > b.cost; });
+        return tiles.size();
+    }
+
+    /**
+     * @brief Tiles of a window filter: planned over the valid data with the index of the raster, if any (see
+     * ValidIndex::planTiles), or covering the whole raster otherwise
+     *
+     * @param index Valid pixel index of the raster, or nullptr. Ignored if it does not match the raster size
+     * @param nRows Number of rows of the raster
+     * @param nCols Number of columns of the raster
+     * @param tileSize Side [px] of the tiles
+     * @param bbox Bounding box of the window footprint, relative to the anchor
+     * @param tiles Output list of tiles
+     * @return int Number of tiles
+     */
+    static int planWindowTiles(const ValidIndex *index, int nRows, int nCols, int tileSize, const cv::Rect &bbox, std::vector<WindowTile> &tiles)
+    {
+        if (index != nullptr && index->rows == nRows && index->cols == nCols)
+            return index->planTiles(tileSize, bbox, tiles);
+        return buildWindowTiles(nRows, nCols, tileSize, tiles);
+    }
+
+    /**
+     * @brief Retrieve the scratch buffers of the calling thread. They are created on first use and live as long as the
+     * thread, so they are shared by every pixel and every call to the window filters executed by that thread.
+     * @details thread_local is used instead of omp_get_thread_num() indexing, as the tiles of window filters run as tasks
+     * of whatever team is active (e.g. the heading loop), so several filters can share the same thread numbers
+     *
+     * @return WindowScratch& Buffers owned by the calling thread
+     */
+    WindowScratch &getWindowScratch()
+    {
+        static thread_local WindowScratch scratch;
+        return scratch;
+    }
+
+    /**
+     * @brief Gather the valid points covered by a footprint anchored at (row, col), reading them straight from the raster.
+     * Equivalent to masking the raster window with both the kernel and the valid data mask and calling
+     * convertMatrix2Vector_Points over the result, without building any intermediate image
+     *
+     * @param raster Source elevation raster (RASTER_TYPE)
+     * @param nodata No-data value of the raster. Samples equal to ZERO are also excluded
+     * @param row Anchor row in the raster
+     * @param col Anchor column in the raster
+     * @param footprint Sparse kernel description. If its stride matches the raster, span offsets are used for windows away from
+     * the borders, or for every window if the halo margin of the footprint covers it (the halo is read as NODATA)
+     * @param rowLimit Rows at or beyond this index are ignored (window clipping). It must be the raster height if the footprint has a halo margin
+     * @param colLimit Columns at or beyond this index are ignored (window clipping). It must be the raster width if the footprint has a halo margin
+     * @param cRow Raster row used as origin of the Y coordinate of the points
+     * @param cCol Raster column used as origin of the X coordinate of the points
+     * @param sx Horizontal pixel scale
+     * @param sy Vertical pixel scale
+     * @param master Output vector where all the points are appended
+     * @param acum Sum of the elevation of the gathered points. It is accumulated, not reset
+     * @param sensor Output vector where the points inside the sensor footprint are appended
+     * @param diameter Diameter of the sensor footprint, centered at (cRow, cCol)
+     * @return int Number of points inside the sensor footprint
+     */
+    int gatherFootprintPoints(const cv::Mat &raster, double nodata, int row, int col, const KernelFootprint &footprint, int rowLimit, int colLimit,
+                              int cRow, int cCol, double sx, double sy, std::vector<KPoint> &master, double *acum, std::vector<KPoint> &sensor, double diameter)
+    {
+        double diam_th = 0.25f * diameter * diameter;
+        int r = 0;
+        bool inside = (footprint.stride == (int)raster.step1()) && footprint.isInside(row, col, rowLimit, colLimit);
+        const raster_t *anchor = inside ? raster.ptr<raster_t>(row) + col : nullptr;
+        for (const auto &s : footprint.spans)
+        {
+            int rr = row + s.dy;
+            int c0, c1;
+            const raster_t *p;
+            if (inside)
+            {
+                c0 = col + s.x0;
+                c1 = col + s.x1;
+                p = anchor + s.offset;
+            }
+            else
+            {
+                if (rr < 0 || rr >= rowLimit)
+                    continue;
+                c0 = std::max(col + s.x0, 0);
+                c1 = std::min(col + s.x1, colLimit);
+                if (c1 <= c0)
+                    continue;
+                p = raster.ptr<raster_t>(rr) + c0;
+            }
+            double py = (rr - cRow) * sy;
+            for (int c = c0; c < c1; c++, p++)
+            {
+                double pz = *p;
+                if (isNoData(pz, nodata) || pz == 0.0f) // only valid and non-NULL points are included
+                    continue;
+                double px = (c - cCol) * sx;
+                master.emplace_back(px, py, pz);
+                *acum = *acum + pz;
+                if (px * px + py * py < diam_th)
+                {
+                    r++;
+                    sensor.emplace_back(px, py, pz);
+                }
+            }
+        }
+        return r;
+    }
+
+    /**
+     * @brief Transpose the row spans of a footprint into runs of active rows for every kernel column
+     *
+     * @param footprint Sparse kernel description, anchored at its center
+     * @param nCols Number of columns of the raster to be swept
+     * @param upperCandidates Optional upper hull candidate bitmap (8UC1) of the raster, see computeHullCandidates
+     * @return int Number of kernel columns
+     */
+    int HullSweep::setup(const KernelFootprint &footprint, int nCols, const cv::Mat &upperCandidates)
+    {
+        dx0 = footprint.bbox.x;
+        int width = footprint.bbox.width;
+        columnRuns.assign(width, std::vector<int>());
+        // spans are sorted by row, so the rows of every column are appended in increasing order
+        for (const auto &s : footprint.spans)
+        {
+            for (int dx = s.x0; dx < s.x1; dx++)
+            {
+                std::vector<int> &r = columnRuns[dx - dx0];
+                if (!r.empty() && r.back() == s.dy) // extend the last run
+                    r.back() = s.dy + 1;
+                else
+                {
+                    r.push_back(s.dy);
+                    r.push_back(s.dy + 1);
+                }
+            }
+        }
+        candidates = upperCandidates;
+        cache.assign(nCols, HullColumn());
+        for (auto &c : cache)
+            c.valid = false;
+        row = -1;
+        return width;
+    }
+
+    /**
+     * @brief Invalidate every cached column chain if the sweep moves to a different raster row
+     *
+     * @param newRow Raster row to be swept next
+     */
+    void HullSweep::reset(int newRow)
+    {
+        if (newRow == row)
+            return;
+        for (auto &c : cache)
+            c.valid = false;
+        row = newRow;
+    }
+
+    /**
+     * @brief Row runs of kernel column k for the window anchored at (row, col), clipped to the raster and window limits
+     *
+     * @return int Number of runs, zero if the column is outside the kernel or the window
+     */
+    int HullSweep::clipRuns(int k, int row, int col, int rowLimit, int colLimit, std::vector<int> &out) const
+    {
+        out.clear();
+        int j = col + dx0 + k;
+        if (k < 0 || k >= (int)columnRuns.size() || j < 0 || j >= colLimit)
+            return 0;
+        const std::vector<int> &cr = columnRuns[k];
+        for (size_t i = 0; i < cr.size(); i += 2)
+        {
+            int r0 = std::max(row + cr[i], 0);
+            int r1 = std::min(row + cr[i + 1], rowLimit);
+            if (r1 > r0)
+            {
+                out.push_back(r0);
+                out.push_back(r1);
+            }
+        }
+        return out.size() / 2;
+    }
+
+    /**
+     * @brief Check if the rows [r0, r1] are covered by a single run
+     */
+    static inline bool coversRows(const std::vector<int> &runs, int r0, int r1)
+    {
+        for (size_t i = 0; i < runs.size(); i += 2)
+            if (runs[i] <= r0 && r1 < runs[i + 1])
+                return true;
+        return false;
+    }
+
+    /**
+     * @brief Collect the candidate points of the window anchored at (row, col): the upper chain of every covered column.
+     * If a candidate bitmap is available, samples that are not upper hull candidates are skipped as long as their 8
+     * neighbours (and so the pair of samples they lie below) are inside the window. Coordinates, clipping and validity
+     * rules are the same as gatherFootprintPoints
+     *
+     * @param raster Source elevation raster (RASTER_TYPE)
+     * @param nodata No-data value of the raster. Samples equal to ZERO are also excluded
+     * @param row Anchor row in the raster. It must match the row of the last call to reset
+     * @param col Anchor column in the raster
+     * @param rowLimit Rows at or beyond this index are ignored (window clipping)
+     * @param colLimit Columns at or beyond this index are ignored (window clipping)
+     * @param cRow Raster row used as origin of the Y coordinate of the points
+     * @param cCol Raster column used as origin of the X coordinate of the points
+     * @param sx Horizontal pixel scale
+     * @param sy Vertical pixel scale
+     * @param points Output vector where the candidate points are appended
+     * @param acum Sum of the elevation of every valid sample of the window (not only the candidates). It is accumulated, not reset
+     * @return int Number of valid samples of the window (not only the candidates)
+     */
+    int HullSweep::gather(const cv::Mat &raster, double nodata, int row, int col, int rowLimit, int colLimit, int cRow, int cCol,
+                          double sx, double sy, std::vector<KPoint> &points, double *acum)
+    {
+        int n = 0;
+        int width = columnRuns.size();
+        bool prune = !candidates.empty();
+        for (int k = 0; k < width; k++)
+        {
+            int j = col + dx0 + k;
+            if (!clipRuns(k, row, col, rowLimit, colLimit, runs))
+                continue;
+            if (prune)
+            {
+                // the neighbour columns decide which samples are interior to the window, so they are part of the cache key
+                clipRuns(k - 1, row, col, rowLimit, colLimit, runsLeft);
+                clipRuns(k + 1, row, col, rowLimit, colLimit, runsRight);
+            }
+
+            HullColumn &hc = cache[j];
+            if (!hc.valid || hc.runs != runs || (prune && (hc.left != runsLeft || hc.right != runsRight)))
+            {
+                // rebuild the upper chain of the column (monotone chain, rows are already sorted)
+                hc.runs = runs;
+                if (prune)
+                {
+                    hc.left = runsLeft;
+                    hc.right = runsRight;
+                }
+                hc.row.clear();
+                hc.z.clear();
+                hc.n = 0;
+                hc.sum = 0;
+                for (size_t i = 0; i < runs.size(); i += 2)
+                {
+                    size_t first = hc.row.size();
+                    for (int r = runs[i]; r < runs[i + 1]; r++)
+                    {
+                        double z = raster.at<raster_t>(r, j);
+                        if (isNoData(z, nodata) || z == 0.0f) // only valid and non-NULL points are included
+                            continue;
+                        hc.n++;
+                        hc.sum += z;
+                        if (prune && !candidates.at<uchar>(r, j) && r > runs[i] && r + 1 < runs[i + 1] &&
+                            coversRows(runsLeft, r - 1, r + 1) && coversRows(runsRight, r - 1, r + 1))
+                            continue; // below a pair of opposite neighbours, all of them inside the window
+                        // drop the previous vertex while it is on or below the segment to the new sample
+                        while (hc.row.size() >= first + 2)
+                        {
+                            size_t b = hc.row.size() - 1;
+                            double cross = (double)(hc.row[b] - hc.row[b - 1]) * (z - hc.z[b - 1]) - (hc.z[b] - hc.z[b - 1]) * (double)(r - hc.row[b - 1]);
+                            if (cross < 0)
+                                break;
+                            hc.row.pop_back();
+                            hc.z.pop_back();
+                        }
+                        hc.row.push_back(r);
+                        hc.z.push_back(z);
+                    }
+                }
+                hc.valid = true;
+            }
+            n += hc.n;
+            *acum = *acum + hc.sum;
+            double px = (j - cCol) * sx;
+            for (size_t i = 0; i < hc.row.size(); i++)
+                points.emplace_back(px, (hc.row[i] - cRow) * sy, hc.z[i]);
+        }
+        return n;
+    }
+
+    /**
+     * @brief Mark the pixels that can be a vertex of the upper (lower) convex hull of a window. A sample strictly below
+     * (above) the midpoint of a pair of opposite neighbours (N-S, W-E, NW-SE or NE-SW) is below (above) the segment that
+     * joins them, so it can never be an upper (lower) hull vertex of any window containing the three of them. The test
+     * does not depend on the kernel or its heading, so the bitmaps are computed once per raster
+     *
+     * @param raster Source elevation raster (RASTER_TYPE)
+     * @param nodata No-data value of the raster. Samples equal to ZERO are also excluded
+     * @param upper Resulting upper hull candidate bitmap (8UC1, 0/255)
+     * @param lower Resulting lower hull candidate bitmap (8UC1, 0/255)
+     * @return int Number of valid samples that are not candidates of either hull
+     */
+    int computeHullCandidates(const cv::Mat &raster, double nodata, cv::Mat &upper, cv::Mat &lower)
+    {
+        int nRows = raster.rows;
+        int nCols = raster.cols;
+        upper.create(nRows, nCols, CV_8UC1);
+        lower.create(nRows, nCols, CV_8UC1);
+        // opposite neighbour pairs, as (drow, dcol) of one of them. The other one is at (-drow, -dcol)
+        const int pairs[4][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}};
+        int pruned = 0;
+
+#pragma omp parallel for schedule(dynamic) reduction(+ : pruned)
+        for (int row = 0; row < nRows; row++)
+        {
+            const raster_t *src = raster.ptr<raster_t>(row);
+            uchar *up = upper.ptr<uchar>(row);
+            uchar *lo = lower.ptr<uchar>(row);
+            for (int col = 0; col < nCols; col++)
+            {
+                double z = src[col];
+                up[col] = lo[col] = 0;
+                if (isNoData(z, nodata) || z == 0.0f)
+                    continue;
+                bool isUpper = true, isLower = true;
+                for (int k = 0; k < 4; k++)
+                {
+                    int ra = row + pairs[k][0], ca = col + pairs[k][1];
+                    int rb = row - pairs[k][0], cb = col - pairs[k][1];
+                    if (ra < 0 || ra >= nRows || rb < 0 || rb >= nRows || ca < 0 || ca >= nCols || cb < 0 || cb >= nCols)
+                        continue;
+                    double za = raster.at<raster_t>(ra, ca);
+                    double zb = raster.at<raster_t>(rb, cb);
+                    if (isNoData(za, nodata) || za == 0.0f || isNoData(zb, nodata) || zb == 0.0f)
+                        continue;
+                    if (2 * z < za + zb)
+                        isUpper = false;
+                    else if (2 * z > za + zb)
+                        isLower = false;
+                }
+                up[col] = isUpper ? 255 : 0;
+                lo[col] = isLower ? 255 : 0;
+                if (!isUpper && !isLower)
+                    pruned++;
+            }
+        }
+        return pruned;
+    }
+
+    /**
+     * @brief Binary erosion/dilation using the footprint spans and a row prefix count of the set pixels. Every span is
+     * tested in O(1), so the cost per pixel is O(kernel height) rather than O(kernel area)
+     *
+     * @param src Binary source mask (8UC1), non-zero values are considered set
+     * @param footprint Sparse kernel description, anchored as the cv morphology operators
+     * @param dst Resulting mask (8UC1, 0/255). It can be the same as src
+     * @param erode true for erosion, false for dilation
+     * @return int Error code, if any
+     */
+    static int computeMorphMask(const cv::Mat &src, const KernelFootprint &footprint, cv::Mat &dst, bool erode)
+    {
+        if (src.type() != CV_8UC1)
+            return ERROR_WRONG_ARGUMENT;
+        int rows = src.rows;
+        int cols = src.cols;
+        int step = cols + 1;
+        std::vector<int> count((size_t)rows * step);
+#pragma omp parallel for schedule(static)
+        for (int r = 0; r < rows; r++)
+        {
+            const uchar *p = src.ptr<uchar>(r);
+            int *t = &count[(size_t)r * step];
+            t[0] = 0;
+            for (int c = 0; c < cols; c++)
+                t[c + 1] = t[c] + (p[c] != 0);
+        }
+        KernelFootprint fp = footprint;
+        fp.setStride(step);
+
+        cv::Mat out(rows, cols, CV_8UC1);
+#pragma omp parallel for schedule(dynamic)
+        for (int row = 0; row < rows; row++)
+        {
+            uchar *o = out.ptr<uchar>(row);
+            for (int col = 0; col < cols; col++)
+            {
+                // pixels outside the raster are neutral for both operators (cv default border)
+                bool set = erode;
+                if (fp.isInside(row, col, rows, cols))
+                {
+                    const int *anchor = &count[(size_t)row * step + col];
+                    for (const auto &s : fp.spans)
+                    {
+                        int n = anchor[s.offset + s.x1 - s.x0] - anchor[s.offset];
+                        if (erode ? (n < s.x1 - s.x0) : (n > 0))
+                        {
+                            set = !erode;
+                            break;
+                        }
+                    }
+                }
+                else
+                {
+                    for (const auto &s : fp.spans)
+                    {
+                        int r = row + s.dy;
+                        if (r < 0 || r >= rows)
+                            continue;
+                        int c0 = std::max(col + s.x0, 0);
+                        int c1 = std::min(col + s.x1, cols);
+                        if (c1 <= c0)
+                            continue;
+                        const int *t = &count[(size_t)r * step];
+                        int n = t[c1] - t[c0];
+                        if (erode ? (n < c1 - c0) : (n > 0))
+                        {
+                            set = !erode;
+                            break;
+                        }
+                    }
+                }
+                o[col] = set ? 255 : 0;
+            }
+        }
+        dst = out;
+        return NO_ERROR;
+    }
+
+    /**
+     * @brief Binary erosion of a mask with a sparse footprint. Matches cv::erode for 0/255 masks and default anchor/border
+     *
+     * @param src Binary source mask (8UC1)
+     * @param footprint Sparse kernel description, typically KernelBank::shape
+     * @param dst Resulting mask (8UC1, 0/255)
+     * @return int Error code, if any. ERROR_WRONG_ARGUMENT for non 8UC1 inputs
+     */
+    int erodeMask(const cv::Mat &src, const KernelFootprint &footprint, cv::Mat &dst)
+    {
+        return computeMorphMask(src, footprint, dst, true);
+    }
+
+    /**
+     * @brief Binary dilation of a mask with a sparse footprint. Matches cv::dilate for 0/255 masks and default anchor/border
+     *
+     * @param src Binary source mask (8UC1)
+     * @param footprint Sparse kernel description, typically KernelBank::shape
+     * @param dst Resulting mask (8UC1, 0/255)
+     * @return int Error code, if any. ERROR_WRONG_ARGUMENT for non 8UC1 inputs
+     */
+    int dilateMask(const cv::Mat &src, const KernelFootprint &footprint, cv::Mat &dst)
+    {
+        return computeMorphMask(src, footprint, dst, false);
+    }
+
+    /**
+     * @brief Analytic eigen-decomposition of a symmetric 3x3 matrix, restricted to its smallest eigenpair.
+     * Eigenvalues are computed with the trigonometric solution of the characteristic cubic, and the eigenvector
+     * as the largest cross product between the rows of (A - lambda.I)
+     *
+     * @param A Upper triangle of the matrix, as [a00 a01 a02 a11 a12 a22]
+     * @param v Unit eigenvector associated to the smallest eigenvalue. Defaults to [0 0 1] for degenerate matrices
+     * @return double Smallest eigenvalue
+     */
+    double computeSmallestEigenvector(const double *A, double *v)
+    {
+        double a00 = A[0], a01 = A[1], a02 = A[2], a11 = A[3], a12 = A[4], a22 = A[5];
+        v[0] = 0;
+        v[1] = 0;
+        v[2] = 1;
+
+        double q = (a00 + a11 + a22) / 3.0;
+        double b00 = a00 - q, b11 = a11 - q, b22 = a22 - q;
+        double p1 = a01 * a01 + a02 * a02 + a12 * a12;
+        double p2 = b00 * b00 + b11 * b11 + b22 * b22 + 2.0 * p1;
+        double p = sqrt(p2 / 6.0);
+        if (p <= 1e-300) // A = q.I, any direction is an eigenvector
+            return q;
+
+        double det = b00 * (b11 * b22 - a12 * a12) - a01 * (a01 * b22 - a12 * a02) + a02 * (a01 * a12 - b11 * a02);
+        double r = 0.5 * det / (p * p * p);
+        r = std::min(1.0, std::max(-1.0, r));
+        double phi = acos(r) / 3.0;
+        double lambda = q + 2.0 * p * cos(phi + (2.0 * M_PI / 3.0)); // smallest of the three roots
+
+        // rows of (A - lambda.I), the eigenvector is orthogonal to all of them
+        double r0[3] = {a00 - lambda, a01, a02};
+        double r1[3] = {a01, a11 - lambda, a12};
+        double r2[3] = {a02, a12, a22 - lambda};
+        double c[3][3] = {{r0[1] * r1[2] - r0[2] * r1[1], r0[2] * r1[0] - r0[0] * r1[2], r0[0] * r1[1] - r0[1] * r1[0]},
+                          {r0[1] * r2[2] - r0[2] * r2[1], r0[2] * r2[0] - r0[0] * r2[2], r0[0] * r2[1] - r0[1] * r2[0]},
+                          {r1[1] * r2[2] - r1[2] * r2[1], r1[2] * r2[0] - r1[0] * r2[2], r1[0] * r2[1] - r1[1] * r2[0]}};
+        int best = 0;
+        double bestNorm = 0;
+        for (int i = 0; i < 3; i++)
+        {
+            double nrm = c[i][0] * c[i][0] + c[i][1] * c[i][1] + c[i][2] * c[i][2];
+            if (nrm > bestNorm)
+            {
+                bestNorm = nrm;
+                best = i;
+            }
+        }
+        if (bestNorm <= 1e-300) // repeated smallest eigenvalue, the eigenvector is not unique
+            return lambda;
+        double inv = 1.0 / sqrt(bestNorm);
+        v[0] = c[best][0] * inv;
+        v[1] = c[best][1] * inv;
+        v[2] = c[best][2] * inv;
+        return lambda;
+    }
+
+    /**
+     * @brief Centred covariance matrix of a set of moments, scaled to world units
+     *
+     * @param m Moments in pixel units (x: column, y: row, z: elevation)
+     * @param sx Horizontal pixel scale
+     * @param sy Vertical pixel scale
+     * @param A Upper triangle of the covariance matrix [a00 a01 a02 a11 a12 a22]. Zero if there are less than 3 points
+     */
+    static inline void computeMomentCovariance(const PlaneMoments &m, double sx, double sy, double *A)
+    {
+        if (m.n < 3)
+        {
+            A[0] = A[1] = A[2] = A[3] = A[4] = A[5] = 0;
+            return;
+        }
+        double in = 1.0 / m.n;
+        A[0] = (m.xx - m.x * m.x * in) * in * sx * sx;
+        A[1] = (m.xy - m.x * m.y * in) * in * sx * sy;
+        A[2] = (m.xz - m.x * m.z * in) * in * sx;
+        A[3] = (m.yy - m.y * m.y * in) * in * sy * sy;
+        A[4] = (m.yz - m.y * m.z * in) * in * sy;
+        A[5] = (m.zz - m.z * m.z * in) * in;
+    }
+
+    /**
+     * @brief Closed-form total least-squares plane for a set of moments expressed in pixel units. The normal is the
+     * eigenvector of the smallest eigenvalue of the centred covariance matrix, as in linear_least_squares_fitting_3
+     *
+     * @param m Moments in pixel units (x: column, y: row, z: elevation)
+     * @param sx Horizontal pixel scale
+     * @param sy Vertical pixel scale
+     * @param normal Unit normal of the fitting plane in world units. Vertical [0 0 1] if there are less than 3 points
+     * @return int Error code, if any
+     */
+    int computeMomentNormal(const PlaneMoments &m, double sx, double sy, double *normal)
+    {
+        double A[6];
+        computeMomentCovariance(m, sx, sy, A);
+        computeSmallestEigenvector(A, normal);
+        return (m.n < 3) ? ERROR_WRONG_ARGUMENT : NO_ERROR;
+    }
+
+    /**
+     * @brief Slope of the least-squares plane, as the angle between its normal and the vertical axis
+     *
+     * @param m Moments in pixel units
+     * @param sx Horizontal pixel scale
+     * @param sy Vertical pixel scale
+     * @return double Slope in degrees, in the range [0, 90]
+     */
+    double computeMomentSlope(const PlaneMoments &m, double sx, double sy)
+    {
+        double normal[3];
+        computeMomentNormal(m, sx, sy, normal);
+        double nz = std::min(1.0, fabs(normal[2]));
+        return acos(nz) * 180.0 / M_PI;
+    }
+
+    /**
+     * @brief Batched slope evaluation for a set of moments. Covariance matrices are stored as structure of arrays and the
+     * closed-form eigen-solver runs on the SIMD kernels selected at startup (see lad_simd.hpp), scalar for the remainder
+     *
+     * @param m Array of moments in pixel units
+     * @param count Number of elements of the array
+     * @param sx Horizontal pixel scale
+     * @param sy Vertical pixel scale
+     * @param slope Output array, slope in degrees for every element of m
+     * @return int Error code, if any
+     */
+    int computeMomentSlopes(const PlaneMoments *m, int count, double sx, double sy, double *slope)
+    {
+        if (count <= 0)
+            return NO_ERROR;
+        // per-thread buffer, reused between calls
+        static thread_local std::vector<double> soa;
+        if (soa.size() < 7 * (size_t)count)
+            soa.resize(7 * (size_t)count);
+        double *a[6];
+        for (int k = 0; k < 6; k++)
+            a[k] = &soa[k * (size_t)count];
+        double *nz = &soa[6 * (size_t)count];
+
+        for (int i = 0; i < count; i++)
+        {
+            double A[6];
+            computeMomentCovariance(m[i], sx, sy, A);
+            for (int k = 0; k < 6; k++)
+                a[k][i] = A[k];
+        }
+
+        // complete groups of lanes run on the dispatched SIMD kernel, the tail on the scalar solver
+        int i = getSimdKernels().computeVerticalComponents(a, count, nz);
+        for (; i < count; i++)
+        {
+            double A[6] = {a[0][i], a[1][i], a[2][i], a[3][i], a[4][i], a[5][i]};
+            double v[3];
+            computeSmallestEigenvector(A, v);
+            nz[i] = fabs(v[2]);
+        }
+
+        for (int k = 0; k < count; k++)
+            slope[k] = acos(std::min(1.0, nz[k])) * 180.0 / M_PI;
+        return NO_ERROR;
+    }
+
+    /**
+     * @brief Moment based implementation of the FILTER_SLOPE and FILTER_MEAN window filters. It reproduces the window
+     * extent and the validity rules of the point gathering path of Pipeline::applyWindowFilter
+     *
+     * @param raster Source elevation raster (RASTER_TYPE)
+     * @param nodata No-data value of the raster
+     * @param table Moment table of the raster, see MomentTable::build
+     * @param footprint Sparse description of the sliding kernel, anchored at its center
+     * @param sx Horizontal pixel scale
+     * @param sy Vertical pixel scale
+     * @param filtertype FILTER_SLOPE or FILTER_MEAN
+     * @param dst Output raster (RASTER_TYPE), already allocated and filled with RASTER_NODATA
+     * @param tileSize Side [px] of the output tiles, see buildWindowTiles
+     * @param index Optional valid pixel index of the raster, to plan the tiles over the valid data only (see ValidIndex::planTiles)
+     * @return int Error code, if any
+     */
+    int computeMomentFilter(const cv::Mat &raster, double nodata, const MomentTable &table, const KernelFootprint &footprint, double sx, double sy,
+                            int filtertype, cv::Mat &dst, int tileSize, const ValidIndex *index)
+    {
+        if (filtertype != FILTER_SLOPE && filtertype != FILTER_MEAN)
+            return ERROR_WRONG_ARGUMENT;
+
+        int nRows = raster.rows;
+        int nCols = raster.cols;
+
+        std::vector<WindowTile> tiles;
+        planWindowTiles(index, nRows, nCols, tileSize, footprint.bbox, tiles);
+        forEachWindowTile(tiles, [&](const WindowTile &tile)
+        {
+            // the moments of a whole tile row are collected first, and then fitted in a single batch
+            int width = tile.col1 - tile.col0;
+            std::vector<PlaneMoments> rowMoments(width);
+            std::vector<int> rowIndex(width);
+            std::vector<double> rowSlope(width);
+            for (int row = tile.row0; row < tile.row1; row++)
+            {
+                const raster_t *src = raster.ptr<raster_t>(row);
+                raster_t *out = dst.ptr<raster_t>(row);
+                int nValid = 0;
+                for (int col = tile.col0; col < tile.col1; col++)
+                {
+                    if (isNoData(src[col], nodata))
+                        continue;
+                    out[col] = RASTER_NODATA;
+                    PlaneMoments &m = rowMoments[nValid];
+                    // windows crossing the border keep every sample inside the raster, as the gathering path does
+                    table.accumulate(row, col, footprint, nRows, nCols, m);
+                    // same minimum number of points required by the gathering path
+                    if (m.n <= 5)
+                        continue;
+                    if (filtertype == FILTER_MEAN)
+                        out[col] = table.zRef + m.z / m.n;
+                    else
+                        rowIndex[nValid++] = col;
+                }
+                if (filtertype == FILTER_SLOPE)
+                {
+                    computeMomentSlopes(rowMoments.data(), nValid, sx, sy, rowSlope.data());
+                    for (int i = 0; i < nValid; i++)
+                        out[rowIndex[i]] = rowSlope[i];
+                }
+            }
+        });
+        return NO_ERROR;
+    }
+
+    /**
+     * @brief Heading-batched version of computeMomentFilter. The moment table is shared by every footprint, so a pixel
+     * neighbourhood is visited once for the whole rotation sweep. Each heading keeps its own window extent
+     *
+     * @param raster Source elevation raster (RASTER_TYPE)
+     * @param nodata No-data value of the raster
+     * @param table Moment table of the raster, see MomentTable::build
+     * @param footprints Sparse description of every (rotated) sliding kernel, anchored at their centers
+     * @param sx Horizontal pixel scale
+     * @param sy Vertical pixel scale
+     * @param filtertype FILTER_SLOPE or FILTER_MEAN
+     * @param dst Output rasters (RASTER_TYPE), one per footprint. They are (re)allocated here
+     * @param tileSize Side [px] of the output tiles, see buildWindowTiles
+     * @param index Optional valid pixel index of the raster, to plan the tiles over the valid data only (see ValidIndex::planTiles)
+     * @return int Error code, if any
+     */
+    int computeMomentFilter(const cv::Mat &raster, double nodata, const MomentTable &table, const std::vector<KernelFootprint> &footprints, double sx,
+                            double sy, int filtertype, std::vector<cv::Mat> &dst, int tileSize, const ValidIndex *index)
+    {
+        if (filtertype != FILTER_SLOPE && filtertype != FILTER_MEAN)
+            return ERROR_WRONG_ARGUMENT;
+        int nK = footprints.size();
+        if (nK == 0)
+            return ERROR_WRONG_ARGUMENT;
+
+        int nRows = raster.rows;
+        int nCols = raster.cols;
+        dst.resize(nK);
+        for (auto &d : dst)
+        {
+            d.create(nRows, nCols, RASTER_TYPE);
+            if (index != nullptr) // tiles without valid pixels are skipped
+                d.setTo(RASTER_NODATA);
+        }
+
+        std::vector<WindowTile> tiles;
+        cv::Rect reach = footprints[0].bbox; // area read by the windows of every heading
+        for (auto &f : footprints)
+            reach |= f.bbox;
+        planWindowTiles(index, nRows, nCols, tileSize, reach, tiles);
+        forEachWindowTile(tiles, [&](const WindowTile &tile)
+        {
+            // moments of every heading for the current pixel, fitted in a single batch
+            std::vector<PlaneMoments> m(nK);
+            std::vector<double> slope(nK);
+            std::vector<raster_t *> out(nK);
+            for (int row = tile.row0; row < tile.row1; row++)
+            {
+                const raster_t *src = raster.ptr<raster_t>(row);
+                for (int k = 0; k < nK; k++)
+                    out[k] = dst[k].ptr<raster_t>(row);
+                for (int col = tile.col0; col < tile.col1; col++)
+                {
+                    if (isNoData(src[col], nodata))
+                    {
+                        for (int k = 0; k < nK; k++)
+                            out[k][col] = RASTER_NODATA;
+                        continue;
+                    }
+                    for (int k = 0; k < nK; k++)
+                    {
+                        table.accumulate(row, col, footprints[k], nRows, nCols, m[k]);
+                    }
+                    if (filtertype == FILTER_SLOPE)
+                        computeMomentSlopes(m.data(), nK, sx, sy, slope.data());
+                    for (int k = 0; k < nK; k++)
+                    {
+                        if (m[k].n <= 5)
+                            out[k][col] = RASTER_NODATA;
+                        else if (filtertype == FILTER_MEAN)
+                            out[k][col] = table.zRef + m[k].z / m[k].n;
+                        else
+                            out[k][col] = slope[k];
+                    }
+                }
+            }
+        });
+        return NO_ERROR;
+    }
+
+    /**
+     * @brief FILTER_CONVEX_SLOPE window filter swept row by row. Each thread keeps a HullSweep, so consecutive windows of
+     * a row share the column chains and only the reduced candidate set reaches the convex hull plane solver. It reproduces
+     * the window extent, the validity rules and the output of the point gathering path of Pipeline::applyWindowFilter
+     *
+     * @param raster Source elevation raster (RASTER_TYPE)
+     * @param nodata No-data value of the raster
+     * @param footprint Sparse description of the sliding kernel, anchored at its center
+     * @param sx Horizontal pixel scale
+     * @param sy Vertical pixel scale
+     * @param dst Output raster (RASTER_TYPE), already allocated and filled with RASTER_NODATA
+     * @param upperCandidates Optional upper hull candidate bitmap (8UC1) used to prune the window samples
+     * @param hullSolver Convex hull plane solver (HULL_ENVELOPE | HULL_CGAL)
+     * @param tileSize Side [px] of the output tiles, see buildWindowTiles. The column chains are shared along each tile row
+     * @param pending Optional mask (8UC1): only the windows of non-zero pixels are evaluated, see computeSlopeScreen
+     * @param index Optional valid pixel index of the raster, to plan the tiles over the valid data only (see ValidIndex::planTiles)
+     * @return int Error code, if any
+     */
+    int computeConvexSweepFilter(const cv::Mat &raster, double nodata, const KernelFootprint &footprint, double sx, double sy, cv::Mat &dst,
+                                 const cv::Mat &upperCandidates, int hullSolver, int tileSize, const cv::Mat &pending, const ValidIndex *index)
+    {
+        int nRows = raster.rows;
+        int nCols = raster.cols;
+
+        std::vector<WindowTile> tiles;
+        planWindowTiles(index, nRows, nCols, tileSize, footprint.bbox, tiles);
+        forEachWindowTile(tiles, [&](const WindowTile &tile)
+        {
+            HullSweep sweep;
+            sweep.setup(footprint, nCols, upperCandidates);
+            std::vector<KPoint> points;
+            for (int row = tile.row0; row < tile.row1; row++)
+            {
+                const raster_t *src = raster.ptr<raster_t>(row);
+                const uchar *pend = pending.empty() ? nullptr : pending.ptr<uchar>(row);
+                raster_t *out = dst.ptr<raster_t>(row);
+                sweep.reset(row);
+                for (int col = tile.col0; col < tile.col1; col++)
+                {
+                    if (isNoData(src[col], nodata) || (pend && !pend[col])) // skipped windows do not invalidate the column cache
+                        continue;
+                    double acum = 0;
+                    points.clear();
+                    // same window extent and coordinate origin (the anchor) of the gathering path
+                    int n = sweep.gather(raster, nodata, row, col, nRows, nCols, row, col, sx, sy, points, &acum);
+                    if (n <= 5) // same minimum number of points required by the gathering path
+                        continue;
+                    // shift height/depth by Z-mean value to improve stability
+                    KVector zmean(0, 0, acum / n);
+                    for (auto &p : points)
+                        p = p - zmean;
+                    KPlane plane = computeConvexHullPlane(points, hullSolver);
+                    out[col] = computePlaneSlope(plane, KVector(0, 0, 1));
+                }
+            }
+        });
+        return NO_ERROR;
+    }
+
+    /**
+     * @brief First tier of the two-tier convex slope screening. Every window gets a cheap upper bound of its hull slope,
+     * and only the windows whose bound reaches the threshold are flagged as pending for the exact evaluation (see the
+     * pending mask of computeWindowFilter and computeConvexSweepFilter). Windows with too few points are left NODATA,
+     * as in the exact path, so comparing dst against the threshold gives the same binary map as the exact slope.
+     * @details The hull facet above the anchor supports the concave upper envelope of the window, so its gradient is
+     * bounded by (zmax - zmin) / r, where r is the distance from the anchor to the border of the XY hull. Subtracting
+     * any plane L from the samples shears the upper hull without changing its facets, so the bound is applied to the
+     * residuals of the least-squares plane (from the moment table): |g| <= |grad L| + (rmax - rmin) / r. r is bounded
+     * from below with the farthest valid samples along the kernel axes. Only windows clearly below the threshold are
+     * resolved, and dst holds their upper bound. The least-squares slope is not screened: its exact value is already a
+     * single moment pass (ENGINE_MOMENTS)
+     *
+     * @param raster Source elevation raster (RASTER_TYPE)
+     * @param nodata No-data value of the raster
+     * @param table Moment table of the raster, see MomentTable::build
+     * @param footprint Window footprint of the exact evaluation, anchored at its center
+     * @param sx Horizontal pixel scale
+     * @param sy Vertical pixel scale
+     * @param filtertype Slope filter to be screened (FILTER_CONVEX_SLOPE)
+     * @param threshold Slope threshold [deg] the output will be compared against
+     * @param margin Guard band [deg] below the threshold, covering the rounding difference between both tiers
+     * @param dst Output raster (RASTER_TYPE), already allocated and filled with RASTER_NODATA. Resolved windows are written
+     * @param pending Output mask (8UC1), non-zero for the windows that need the exact evaluation
+     * @param tileSize Side [px] of the output tiles, see buildWindowTiles
+     * @param index Optional valid pixel index of the raster, to plan the tiles over the valid data only (see ValidIndex::planTiles)
+     * @return int Error code, ERROR_WRONG_ARGUMENT for any other filter or a table not matching the raster
+     */
+    int computeSlopeScreen(const cv::Mat &raster, double nodata, const MomentTable &table, const KernelFootprint &footprint, double sx, double sy,
+                           int filtertype, double threshold, double margin, cv::Mat &dst, cv::Mat &pending, int tileSize, const ValidIndex *index)
+    {
+        int nRows = raster.rows;
+        int nCols = raster.cols;
+        if (table.rows != nRows || table.cols != nCols || filtertype != FILTER_CONVEX_SLOPE)
+            return ERROR_WRONG_ARGUMENT;
+        pending = cv::Mat::zeros(nRows, nCols, CV_8UC1);
+
+        // kernel axes through the anchor: span of the anchor row, and rows (sorted) whose span contains the anchor column
+        int axisX0 = 0, axisX1 = 0;
+        std::vector<int> axisRows;
+        for (const auto &s : footprint.spans)
+        {
+            if (s.dy == 0)
+            {
+                axisX0 = s.x0;
+                axisX1 = s.x1;
+            }
+            if (s.x0 <= 0 && 0 < s.x1)
+                axisRows.push_back(s.dy);
+        }
+        // offset from the anchor of the query point of computeConvexHullPlane, bounds both the CGAL and the envelope points
+        double qr = sqrt(2.0) * (0.0001 + ENVELOPE_QUERY_NUDGE);
+
+        std::vector<WindowTile> tiles;
+        planWindowTiles(index, nRows, nCols, tileSize, footprint.bbox, tiles);
+        forEachWindowTile(tiles, [&](const WindowTile &tile)
+        {
+            auto valid = [&](int r, int c) -> bool
+            {
+                if (r < 0 || r >= nRows || c < 0 || c >= nCols)
+                    return false;
+                double z = raster.at<raster_t>(r, c);
+                return !isNoData(z, nodata) && z != 0.0;
+            };
+            for (int row = tile.row0; row < tile.row1; row++)
+            {
+                const raster_t *src = raster.ptr<raster_t>(row);
+                raster_t *out = dst.ptr<raster_t>(row);
+                uchar *pend = pending.ptr<uchar>(row);
+                for (int col = tile.col0; col < tile.col1; col++)
+                {
+                    if (isNoData(src[col], nodata))
+                        continue;
+                    PlaneMoments m;
+                    table.accumulate(row, col, footprint, nRows, nCols, m);
+                    if (m.n <= 5) // same minimum number of points required by the exact path
+                        continue;
+                    double A[6], normal[3];
+                    computeMomentCovariance(m, sx, sy, A);
+                    computeSmallestEigenvector(A, normal);
+                    // farthest valid samples along the kernel axes: the diamond they span lies inside the XY hull
+                    int left = 0, right = 0, up = 0, down = 0;
+                    for (int dx = axisX0; dx < 0 && !left; dx++)
+                        left = valid(row, col + dx) ? -dx : 0;
+                    for (int dx = axisX1 - 1; dx > 0 && !right; dx--)
+                        right = valid(row, col + dx) ? dx : 0;
+                    for (size_t k = 0; k < axisRows.size() && axisRows[k] < 0 && !up; k++)
+                        up = valid(row + axisRows[k], col) ? -axisRows[k] : 0;
+                    for (int k = (int)axisRows.size() - 1; k >= 0 && axisRows[k] > 0 && !down; k--)
+                        down = valid(row + axisRows[k], col) ? axisRows[k] : 0;
+                    double a = std::min(left, right) * fabs(sx);
+                    double b = std::min(up, down) * fabs(sy);
+                    double r = (a > 0 && b > 0) ? a * b / sqrt(a * a + b * b) - qr : 0;
+                    if (r <= 0)
+                    {
+                        pend[col] = 255;
+                        continue;
+                    }
+                    if (fabs(normal[2]) < 1e-3) // (nearly) vertical least-squares plane
+                    {
+                        pend[col] = 255;
+                        continue;
+                    }
+                    // residual range against the least-squares plane, z - (gx.x + gy.y) (the constant term is irrelevant)
+                    double gx = -normal[0] / normal[2] * sx; // per pixel
+                    double gy = -normal[1] / normal[2] * sy;
+                    double rmin = DBL_MAX, rmax = -DBL_MAX;
+                    for (const auto &s : footprint.spans)
+                    {
+                        int rr = row + s.dy;
+                        if (rr < 0 || rr >= nRows)
+                            continue;
+                        int c0 = std::max(col + s.x0, 0);
+                        int c1 = std::min(col + s.x1, nCols);
+                        const raster_t *p = raster.ptr<raster_t>(rr);
+                        double base = gy * s.dy + gx * (c0 - col);
+                        for (int c = c0; c < c1; c++, base += gx)
+                        {
+                            double z = p[c];
+                            if (isNoData(z, nodata) || z == 0.0)
+                                continue;
+                            rmin = std::min(rmin, z - base);
+                            rmax = std::max(rmax, z - base);
+                        }
+                    }
+                    double grad = sqrt(normal[0] * normal[0] + normal[1] * normal[1]) / fabs(normal[2]); // |grad L|, world units
+                    double bound = atan(grad + (rmax - rmin) / r) * 180.0 / M_PI;
+                    if (bound > threshold - margin)
+                        pend[col] = 255;
+                    else
+                        out[col] = bound;
+                }
+            }
+        });
+        return NO_ERROR;
+    }
+
+    /**
+     * @brief Measurability score of a point at normal distance d of the plane: 1 inside the optimal range, decaying
+     * with the suboptimal range beyond it
+     */
+    static inline double computeMeasurabilityScore(double d, double zOptimal, double zSuboptimal)
+    {
+        double zit = fabs(d);
+        if (zit < zOptimal)
+            return 1.0;
+        return 1 / (1 + (zit - zOptimal) / zSuboptimal);
+    }
+
+    /**
+     * @brief Value of a plane-fit filter for the points of a window, as the gathering engine evaluates it. Used to validate
+     * the subsampled footprints, see computeSubsampleDeviation
+     *
+     * @param points Points of the window, relative to the anchor
+     * @param sensor Points of the sensor footprint, at full resolution (FILTER_GEOTECH only)
+     * @param filtertype Plane-fit filter (FILTER_SLOPE, FILTER_PLANE, FILTER_DISTANCE, FILTER_RESIDUAL or FILTER_GEOTECH)
+     * @param zOptimal Optimal range [m] of the sensor
+     * @param zSuboptimal Suboptimal range [m] of the sensor
+     * @param distances Scratch buffer of point to plane distances
+     * @return double Filter value: slope [deg] for SLOPE and PLANE, measurability score for DISTANCE and GEOTECH, RMS [m] for RESIDUAL
+     */
+    static double computePlaneFilterValue(const std::vector<KPoint> &points, const std::vector<KPoint> &sensor, int filtertype, double zOptimal,
+                                          double zSuboptimal, std::vector<double> &distances)
+    {
+        KPlane plane = computeFittingPlane(points);
+        if (filtertype == FILTER_SLOPE || filtertype == FILTER_PLANE)
+            return computePlaneSlope(plane, KVector(0, 0, 1));
+        const std::vector<KPoint> &scored = (filtertype == FILTER_GEOTECH) ? sensor : points;
+        if (scored.empty())
+            return 0;
+        computePlaneDistance(plane, scored, distances);
+        double value = 0;
+        for (auto d : distances)
+            value += (filtertype == FILTER_RESIDUAL) ? d * d : computeMeasurabilityScore(d, zOptimal, zSuboptimal);
+        value /= scored.size();
+        return (filtertype == FILTER_RESIDUAL) ? sqrt(value) : value;
+    }
+
+    /**
+     * @brief Validate a subsampled footprint for a plane-fit filter: the filter value of the subsampled window is compared
+     * against the value of the complete window, for windows anchored on a regular grid of about nSamples valid pixels. The
+     * sensor points of FILTER_GEOTECH are always scored at full resolution, only the plane comes from the subsample
+     *
+     * @param raster Source elevation raster (RASTER_TYPE)
+     * @param nodata No-data value of the raster
+     * @param full Complete footprint, anchored at its center
+     * @param sampled Subsampled footprint, see KernelFootprint::subsample
+     * @param sx Horizontal pixel scale
+     * @param sy Vertical pixel scale
+     * @param filtertype Plane-fit filter to validate, see computePlaneFilterValue
+     * @param diameter Diameter [m] of the sensor footprint (FILTER_GEOTECH)
+     * @param zOptimal Optimal range [m] of the sensor (FILTER_DISTANCE, FILTER_GEOTECH)
+     * @param zSuboptimal Suboptimal range [m] of the sensor (FILTER_DISTANCE, FILTER_GEOTECH)
+     * @param nSamples Approximate number of validation windows
+     * @param meanDeviation Optional output mean absolute deviation, in the units of the filter
+     * @return double Maximum absolute deviation, in the units of the filter. Zero if no window could be validated
+     */
+    double computeSubsampleDeviation(const cv::Mat &raster, double nodata, const KernelFootprint &full, const KernelFootprint &sampled, double sx, double sy,
+                                     int filtertype, double diameter, double zOptimal, double zSuboptimal, int nSamples, double *meanDeviation)
+    {
+        int nRows = raster.rows;
+        int nCols = raster.cols;
+        // validation anchors: regular grid over the raster, with the same aspect ratio
+        int step = std::max(1, (int)sqrt((double)nRows * nCols / std::max(nSamples, 1)));
+        KernelFootprint a = full, b = sampled;
+        a.setStride(raster.step1(), getRasterHalo(raster));
+        b.setStride(raster.step1(), getRasterHalo(raster));
+        double sensorDiameter = (filtertype == FILTER_GEOTECH) ? diameter : 0;
+
+        double maxDev = 0, sumDev = 0;
+        int count = 0;
+#pragma omp parallel for schedule(dynamic) reduction(max : maxDev) reduction(+ : sumDev, count)
+        for (int row = step / 2; row < nRows; row += step)
+        {
+            std::vector<KPoint> points, sensor, unused;
+            std::vector<double> distances;
+            for (int col = step / 2; col < nCols; col += step)
+            {
+                if (isNoData(raster.at<raster_t>(row, col), nodata))
+                    continue;
+                double acum = 0;
+                points.clear();
+                sensor.clear();
+                gatherFootprintPoints(raster, nodata, row, col, a, nRows, nCols, row, col, sx, sy, points, &acum, sensor, sensorDiameter);
+                if (points.size() <= 5)
+                    continue;
+                double valueFull = computePlaneFilterValue(points, sensor, filtertype, zOptimal, zSuboptimal, distances);
+                points.clear();
+                unused.clear();
+                gatherFootprintPoints(raster, nodata, row, col, b, nRows, nCols, row, col, sx, sy, points, &acum, unused, 0);
+                if (points.size() <= 5)
+                    continue;
+                double dev = fabs(computePlaneFilterValue(points, sensor, filtertype, zOptimal, zSuboptimal, distances) - valueFull);
+                maxDev = std::max(maxDev, dev);
+                sumDev += dev;
+                count++;
+            }
+        }
+        if (meanDeviation != nullptr)
+            *meanDeviation = count ? sumDev / count : 0;
+        return maxDev;
+    }
+
+    /**
+     * @brief Validate a slope map against the double precision path: the stored slope of windows anchored on a regular grid
+     * of about nSamples valid pixels is compared against the least-squares fit of their points, gathered and fitted in
+     * double precision. With float32 raster layers (USE_FLOAT32) it measures the error of the reduced precision storage
+     *
+     * @param raster Source elevation raster (RASTER_TYPE)
+     * @param nodata No-data value of the raster
+     * @param footprint Window footprint, anchored at its center
+     * @param sx Horizontal pixel scale
+     * @param sy Vertical pixel scale
+     * @param slope Slope map (RASTER_TYPE) computed from the raster, NODATA windows are skipped
+     * @param nSamples Approximate number of validation windows
+     * @param meanDeviation Optional output mean absolute slope deviation [deg]
+     * @return double Maximum absolute slope deviation [deg], zero if no window could be validated
+     */
+    double computePrecisionDeviation(const cv::Mat &raster, double nodata, const KernelFootprint &footprint, double sx, double sy, const cv::Mat &slope,
+                                     int nSamples, double *meanDeviation)
+    {
+        int nRows = raster.rows;
+        int nCols = raster.cols;
+        int step = std::max(1, (int)sqrt((double)nRows * nCols / std::max(nSamples, 1)));
+        KernelFootprint window = footprint;
+        window.setStride(raster.step1(), getRasterHalo(raster));
+
+        double maxDev = 0, sumDev = 0;
+        int count = 0;
+#pragma omp parallel for schedule(dynamic) reduction(max : maxDev) reduction(+ : sumDev, count)
+        for (int row = step / 2; row < nRows; row += step)
+        {
+            std::vector<KPoint> points, sensor;
+            for (int col = step / 2; col < nCols; col += step)
+            {
+                double stored = slope.at<raster_t>(row, col);
+                if (isNoData(raster.at<raster_t>(row, col), nodata) || isNoData(stored, DEFAULT_NODATA_VALUE))
+                    continue;
+                double acum = 0;
+                points.clear();
+                gatherFootprintPoints(raster, nodata, row, col, window, nRows, nCols, row, col, sx, sy, points, &acum, sensor, 0);
+                if (points.size() <= 5)
+                    continue;
+                double dev = fabs(computePlaneSlope(computeFittingPlane(points), KVector(0, 0, 1)) - stored);
+                maxDev = std::max(maxDev, dev);
+                sumDev += dev;
+                count++;
+            }
+        }
+        if (meanDeviation != nullptr)
+            *meanDeviation = count ? sumDev / count : 0;
+        return maxDev;
+    }
+
+    /**
+     * @brief Default gather hook: points of the footprint anchored at (row, col), see gatherFootprintPoints
+     *
+     * @return int Number of points inside the sensor footprint (zero if the policy has no sensor)
+     */
+    int WindowPolicy::gather(const cv::Mat &raster, double nodata, int row, int col, const KernelFootprint &footprint, int rowLimit, int colLimit,
+                             int cRow, int cCol, double sx, double sy, WindowScratch &scratch, double *acum) const
+    {
+        return gatherFootprintPoints(raster, nodata, row, col, footprint, rowLimit, colLimit, cRow, cCol, sx, sy, scratch.points, acum, scratch.sensor, diameter);
+    }
+
+    bool MeanPolicy::reduce(WindowScratch &scratch, double acum, int nSensor, double &value) const
+    {
+        value = acum / scratch.points.size();
+        return true;
+    }
+
+    bool SlopePolicy::reduce(WindowScratch &scratch, double acum, int nSensor, double &value) const
+    {
+        KPlane plane = computeFittingPlane(scratch.points);
+        value = computePlaneSlope(plane, KVector(0, 0, 1)); // angle of the normal to the plane
+        return true;
+    }
+
+    bool ConvexSlopePolicy::reduce(WindowScratch &scratch, double acum, int nSensor, double &value) const
+    {
+        // shift height/depth by Z-mean value to improve stability
+        KVector zmean(0, 0, acum / scratch.points.size());
+        for (auto &p : scratch.points)
+            p = p - zmean;
+        KPlane plane = computeConvexHullPlane(scratch.points, solver);
+        value = computePlaneSlope(plane, KVector(0, 0, 1));
+        return true;
+    }
+
+    bool DistancePolicy::reduce(WindowScratch &scratch, double acum, int nSensor, double &value) const
+    {
+        KPlane plane = computeFittingPlane(scratch.points);
+        computePlaneDistance(plane, scratch.points, scratch.distances);
+        double score = 0;
+        for (auto d : scratch.distances)
+            score += computeMeasurabilityScore(d, zOptimal, zSuboptimal);
+        value = score / scratch.points.size();
+        return true;
+    }
+
+    bool GeotechPolicy::reduce(WindowScratch &scratch, double acum, int nSensor, double &value) const
+    {
+        if (sensor != nullptr)
+        {
+            KPlane plane = computeFittingPlane(scratch.points);
+            double pl[4] = {plane.a(), plane.b(), plane.c(), plane.d()};
+            value = computeSensorScore(*raster, nodata, scratch.row, scratch.col, *sensor, pl, zOptimal, zSuboptimal);
+            return true;
+        }
+        value = 0; // if no point was captured, we report "ZERO" as total measurability
+        if (!nSensor)
+            return true;
+        KPlane plane = computeFittingPlane(scratch.points);
+        computePlaneDistance(plane, scratch.sensor, scratch.distances);
+        double score = 0;
+        for (auto d : scratch.distances)
+            score += computeMeasurabilityScore(d, zOptimal, zSuboptimal);
+        value = score / nSensor;
+        return true;
+    }
+
+    /**
+     * @brief Mean measurability score of the valid sensor points of the window anchored at (row, col), against a plane
+     * expressed relative to the anchor. Points are read straight from the raster through the offsets of the sensor
+     * footprint, so the loop is the branch-free residual kernel selected at startup (see lad_simd.hpp) when the sensor lies
+     * inside the raster (or its halo)
+     *
+     * @param raster Source elevation raster (RASTER_TYPE)
+     * @param nodata No-data value of the raster. Samples equal to ZERO are also excluded
+     * @param row Anchor row in the raster
+     * @param col Anchor column in the raster
+     * @param sensor Sensor footprint, built for this raster
+     * @param plane Plane coefficients (a, b, c, d), with unit normal (a, b, c)
+     * @param zOptimal Optimal range [m] of the sensor
+     * @param zSuboptimal Suboptimal range [m] of the sensor
+     * @return double Mean score of the sensor points, ZERO if no valid point was captured
+     */
+    double computeSensorScore(const cv::Mat &raster, double nodata, int row, int col, const SensorFootprint &sensor, const double *plane,
+                              double zOptimal, double zSuboptimal)
+    {
+        double a = plane[0], b = plane[1], c = plane[2], d = plane[3];
+        int total = sensor.offset.size();
+        double score = 0;
+        int n = 0;
+        if (sensor.stride == (int)raster.step1() && sensor.isInside(row, col, raster.rows, raster.cols))
+        {
+            const raster_t *anchor = raster.ptr<raster_t>(row) + col;
+#ifdef USE_FLOAT32
+            score = getSimdKernels().computeSensorScore32(anchor, sensor.offset.data(), sensor.x.data(), sensor.y.data(), total, plane,
+                                                           nodata, zOptimal, zSuboptimal, &n);
+#else
+            score = getSimdKernels().computeSensorScore64(anchor, sensor.offset.data(), sensor.x.data(), sensor.y.data(), total, plane,
+                                                           nodata, zOptimal, zSuboptimal, &n);
+#endif
+        }
+        else
+        {
+            for (int k = 0; k < total; k++)
+            {
+                int r = row + sensor.dy[k];
+                int cc = col + sensor.dx[k];
+                if (r < 0 || r >= raster.rows || cc < 0 || cc >= raster.cols)
+                    continue;
+                double z = raster.at<raster_t>(r, cc);
+                if (isNoData(z, nodata) || z == 0.0)
+                    continue;
+                score += computeMeasurabilityScore(a * sensor.x[k] + b * sensor.y[k] + c * z + d, zOptimal, zSuboptimal);
+                n++;
+            }
+        }
+        return n ? score / n : 0; // if no point was captured, we report "ZERO" as total measurability
+    }
+
+    /**
+     * @brief FILTER_GEOTECH evaluated without gathering the window: the least-squares plane of every window comes from
+     * the moment table, and the sensor points are scored through the shared sensor footprint. Both the table and the
+     * sensor footprint are heading independent, so only the plane is recomputed for every heading
+     *
+     * @param raster Source elevation raster (RASTER_TYPE)
+     * @param nodata No-data value of the raster
+     * @param table Moment table of the raster, see MomentTable::build
+     * @param footprint Window footprint, anchored at its center (KernelBank::window)
+     * @param sensor Sensor footprint built for the raster. It must be covered by the window footprint
+     * @param sx Horizontal pixel scale
+     * @param sy Vertical pixel scale
+     * @param zOptimal Optimal range [m] of the sensor
+     * @param zSuboptimal Suboptimal range [m] of the sensor
+     * @param dst Output raster (RASTER_TYPE), already allocated and filled with RASTER_NODATA
+     * @param tileSize Side [px] of the output tiles, see buildWindowTiles
+     * @param pending Optional mask (8UC1): only the windows of non-zero pixels are evaluated
+     * @param index Optional valid pixel index of the raster, to plan the tiles over the valid data only (see ValidIndex::planTiles)
+     * @return int Error code, ERROR_WRONG_ARGUMENT if the sensor is not covered by the window or the table does not match the raster
+     */
+    int computeGeotechFilter(const cv::Mat &raster, double nodata, const MomentTable &table, const KernelFootprint &footprint, const SensorFootprint &sensor,
+                             double sx, double sy, double zOptimal, double zSuboptimal, cv::Mat &dst, int tileSize, const cv::Mat &pending,
+                             const ValidIndex *index)
+    {
+        int nRows = raster.rows;
+        int nCols = raster.cols;
+        if (table.rows != nRows || table.cols != nCols || !sensor.isCoveredBy(footprint))
+            return ERROR_WRONG_ARGUMENT;
+
+        std::vector<WindowTile> tiles;
+        planWindowTiles(index, nRows, nCols, tileSize, footprint.bbox, tiles);
+        forEachWindowTile(tiles, [&](const WindowTile &tile)
+        {
+            for (int row = tile.row0; row < tile.row1; row++)
+            {
+                const raster_t *src = raster.ptr<raster_t>(row);
+                const uchar *pend = pending.empty() ? nullptr : pending.ptr<uchar>(row);
+                raster_t *out = dst.ptr<raster_t>(row);
+                for (int col = tile.col0; col < tile.col1; col++)
+                {
+                    if (isNoData(src[col], nodata) || (pend && !pend[col]))
+                        continue;
+                    PlaneMoments m;
+                    table.accumulate(row, col, footprint, nRows, nCols, m);
+                    if (m.n <= 5) // same minimum number of points required by the gathering path
+                        continue;
+                    double plane[4];
+                    computeMomentNormal(m, sx, sy, plane);
+                    // the plane goes through the centroid of the window, relative to the anchor as the sensor offsets
+                    plane[3] = -(plane[0] * sx * m.x / m.n + plane[1] * sy * m.y / m.n + plane[2] * (table.zRef + m.z / m.n));
+                    out[col] = computeSensorScore(raster, nodata, row, col, sensor, plane, zOptimal, zSuboptimal);
+                }
+            }
+        });
+        return NO_ERROR;
+    }
+
+    /**
+     * @brief Terrain descriptors of a window (TRI, TPI and roughness), evaluated in a single traversal of its points. They
+     * generalise the 3x3 gdaldem definitions to any window footprint: as in gdaldem, TRI and TPI compare the center
+     * against its neighbours only (the center sample, at the window origin, is left out), while the roughness spans
+     * every sample of the window
+     *
+     * @param points Points of the window, relative to the window center
+     * @param center Elevation of the window center
+     * @param tri Output mean absolute elevation difference between the neighbours and the center (nullptr if not required)
+     * @param tpi Output center elevation minus the mean elevation of its neighbours (nullptr if not required)
+     * @param roughness Output elevation range, max - min (nullptr if not required)
+     */
+    void computeTerrainDescriptors(const std::vector<KPoint> &points, double center, double *tri, double *tpi, double *roughness)
+    {
+        if (points.empty())
+            return;
+        double sum = 0, dev = 0;
+        int n = 0;
+        double zmin = points.front().z(), zmax = zmin;
+        for (const auto &p : points)
+        {
+            double z = p.z();
+            zmin = std::min(zmin, z);
+            zmax = std::max(zmax, z);
+            if (p.x() == 0 && p.y() == 0) // the center sample is not a neighbour of itself
+                continue;
+            sum += z;
+            dev += fabs(z - center);
+            n++;
+        }
+        if (tri)
+            *tri = n ? dev / n : 0;
+        if (tpi)
+            *tpi = n ? center - sum / n : 0;
+        if (roughness)
+            *roughness = zmax - zmin;
+    }
+
+    bool TriPolicy::reduce(WindowScratch &scratch, double acum, int nSensor, double &value) const
+    {
+        computeTerrainDescriptors(scratch.points, scratch.center, &value, nullptr, nullptr);
+        return true;
+    }
+
+    bool TpiPolicy::reduce(WindowScratch &scratch, double acum, int nSensor, double &value) const
+    {
+        computeTerrainDescriptors(scratch.points, scratch.center, nullptr, &value, nullptr);
+        return true;
+    }
+
+    bool RoughnessPolicy::reduce(WindowScratch &scratch, double acum, int nSensor, double &value) const
+    {
+        computeTerrainDescriptors(scratch.points, scratch.center, nullptr, nullptr, &value);
+        return true;
+    }
+
+    bool CurvaturePolicy::reduce(WindowScratch &scratch, double acum, int nSensor, double &value) const
+    {
+        double q[6];
+        if (computeFittingQuadric(scratch.points, q) != NO_ERROR)
+            return false; // degenerate window, keep NODATA
+        value = 2 * (q[0] + q[1]);
+        return true;
+    }
+
+    /**
+     * @brief Gathering window engine. For every valid pixel, the policy gathers the points of the window anchored there,
+     * reduces them to a single value and emits it into dst. Windows with 5 points or less are skipped, as they cannot
+     * define a reliable plane. Windows crossing the raster border keep every sample inside the raster. If the raster
+     * has a NODATA halo wide enough for the footprint (RasterLayer::setHalo), no window is clipped at all
+     *
+     * @param raster Source elevation raster (RASTER_TYPE)
+     * @param nodata No-data value of the raster
+     * @param footprint Window footprint, anchored at its center (KernelBank::window)
+     * @param sx Horizontal pixel scale
+     * @param sy Vertical pixel scale
+     * @param policy Filter policy, see WindowPolicy
+     * @param dst Output raster (RASTER_TYPE), already initialized to its NODATA value
+     * @param tileSize Side [px] of the output tiles, see buildWindowTiles
+     * @param pending Optional mask (8UC1): only the windows of non-zero pixels are evaluated, see computeSlopeScreen
+     * @param index Optional valid pixel index of the raster, to plan the tiles over the valid data only (see ValidIndex::planTiles)
+     * @return int Error code, if any
+     */
+    template <class Policy>
+    int computeWindowFilter(const cv::Mat &raster, double nodata, const KernelFootprint &footprint, double sx, double sy, const Policy &policy, cv::Mat &dst,
+                            int tileSize, const cv::Mat &pending, const ValidIndex *index)
+    {
+        int nRows = raster.rows;
+        int nCols = raster.cols;
+        // local copy, as the offsets depend on the stride (and halo) of the source raster
+        KernelFootprint window = footprint;
+        window.setStride(raster.step1(), getRasterHalo(raster));
+
+        std::vector<WindowTile> tiles;
+        planWindowTiles(index, nRows, nCols, tileSize, footprint.bbox, tiles);
+        forEachWindowTile(tiles, [&](const WindowTile &tile)
+        {
+            WindowScratch &scratch = getWindowScratch();
+            for (int row = tile.row0; row < tile.row1; row++)
+            {
+                const raster_t *src = raster.ptr<raster_t>(row);
+                const uchar *pend = pending.empty() ? nullptr : pending.ptr<uchar>(row);
+                raster_t *out = dst.ptr<raster_t>(row);
+                for (int col = tile.col0; col < tile.col1; col++)
+                {
+                    if (isNoData(src[col], nodata) || (pend && !pend[col]))
+                        continue;
+                    double acum = 0;
+                    double value;
+                    scratch.reset(window.nPixels);
+                    scratch.center = src[col];
+                    scratch.row = row;
+                    scratch.col = col;
+                    // points are expressed relative to the anchor, so border windows share the origin of interior ones
+                    int nSensor = policy.gather(raster, nodata, row, col, window, nRows, nCols, row, col, sx, sy, scratch, &acum);
+                    if (scratch.points.size() <= 5) // not enough points to compute a valid plane
+                        continue;
+                    if (policy.reduce(scratch, acum, nSensor, value))
+                        policy.emit(out, col, value);
+                }
+            }
+        });
+        return NO_ERROR;
+    }
+
+    // compile-time specialisations of the engine, selected at runtime by Pipeline::applyWindowFilter
+    template int computeWindowFilter<MeanPolicy>(const cv::Mat &, double, const KernelFootprint &, double, double, const MeanPolicy &, cv::Mat &, int, const cv::Mat &, const ValidIndex *);
+    template int computeWindowFilter<SlopePolicy>(const cv::Mat &, double, const KernelFootprint &, double, double, const SlopePolicy &, cv::Mat &, int, const cv::Mat &, const ValidIndex *);
+    template int computeWindowFilter<ConvexSlopePolicy>(const cv::Mat &, double, const KernelFootprint &, double, double, const ConvexSlopePolicy &, cv::Mat &, int, const cv::Mat &, const ValidIndex *);
+    template int computeWindowFilter<DistancePolicy>(const cv::Mat &, double, const KernelFootprint &, double, double, const DistancePolicy &, cv::Mat &, int, const cv::Mat &, const ValidIndex *);
+    template int computeWindowFilter<GeotechPolicy>(const cv::Mat &, double, const KernelFootprint &, double, double, const GeotechPolicy &, cv::Mat &, int, const cv::Mat &, const ValidIndex *);
+    template int computeWindowFilter<TriPolicy>(const cv::Mat &, double, const KernelFootprint &, double, double, const TriPolicy &, cv::Mat &, int, const cv::Mat &, const ValidIndex *);
+    template int computeWindowFilter<TpiPolicy>(const cv::Mat &, double, const KernelFootprint &, double, double, const TpiPolicy &, cv::Mat &, int, const cv::Mat &, const ValidIndex *);
+    template int computeWindowFilter<RoughnessPolicy>(const cv::Mat &, double, const KernelFootprint &, double, double, const RoughnessPolicy &, cv::Mat &, int, const cv::Mat &, const ValidIndex *);
+    template int computeWindowFilter<CurvaturePolicy>(const cv::Mat &, double, const KernelFootprint &, double, double, const CurvaturePolicy &, cv::Mat &, int, const cv::Mat &, const ValidIndex *);
+
+} // namespace lad
@@ -22,6 +22,7 @@
 #include "lad_enum.hpp"
 #include "lad_processing.hpp"
 #include "lad_thread.hpp"
+#include "lad_simd.hpp"
 
 using namespace std;
 using namespace cv;
@@ -37,6 +38,47 @@ using namespace lad;
 
 logger::ConsoleOutput logc;
 
+/**
+ * @brief Blend the rotated layers prefix + "_rXXX" of every heading into their per pixel mean. NODATA samples of a
+ * heading do not contribute, pixels without any valid heading are NODATA
+ *
+ * @param pipeline Pipeline holding the rotated layers
+ * @param params Pipeline parameters, providing the heading range
+ * @param nIter Number of heading steps
+ * @param prefix Name of the rotated layers, without the heading suffix
+ * @param blend Output blended raster (CV_64FC1)
+ * @return int Error code, if any
+ */
+static int blendRotatedLayers(lad::Pipeline &pipeline, const lad::parameterStruct &params, int nIter, std::string prefix, cv::Mat &blend)
+{
+    std::ostringstream s;
+    cv::Mat acum, count, currentmat, valid;
+    for (int r = 0; r <= nIter; r++)
+    {
+        double currRotation = params.rotationMin + r * params.rotationStep;
+        string currentname = prefix + "_r" + makeFixedLength((int)currRotation, 3);
+        auto apCurrent = dynamic_pointer_cast<RasterLayer>(pipeline.getLayer(currentname));
+        if (apCurrent == nullptr)
+        {
+            s << "Failed to retrieve layer apCurrent [ " << currentname << "], line: " << __LINE__;
+            logc.error("blend", s);
+            return LAYER_NOT_FOUND;
+        }
+        if (acum.empty())
+        {
+            acum = cv::Mat::zeros(apCurrent->rasterData.size(), CV_64FC1);
+            count = cv::Mat::zeros(apCurrent->rasterData.size(), CV_64FC1);
+        }
+        apCurrent->rasterData.convertTo(currentmat, CV_64FC1);
+        lad::computeValidMask(apCurrent->rasterData, apCurrent->getNoDataValue(), valid);
+        cv::add(acum, currentmat, acum, valid);
+        cv::add(count, cv::Scalar(1), count, valid);
+    }
+    cv::divide(acum, count, blend); // zero where no heading is valid
+    blend.setTo(RASTER_NODATA, count == 0);
+    return NO_ERROR;
+}
+
 /*!
     @fn     int main(int argc, char* argv[])
     @brief  Main function
@@ -170,6 +212,72 @@ int main(int argc, char *argv[])
         logc.warn("main-config", "Using LMS PLANE algorithm for slope estimation");
     }
 
+    if (argWindowEngine)
+    {
+        auto option = args::get(argWindowEngine);
+        if (option == "MOMENTS")
+            params.windowEngine = lad::WindowEngine::ENGINE_MOMENTS;
+        else if (option == "GATHER")
+        {
+            params.windowEngine = lad::WindowEngine::ENGINE_GATHER;
+            logc.warn("main-config", "Using point GATHER engine for window filters");
+        }
+        else
+        {
+            logc.error("main-config", "Unknown window filter engine");
+            return -1;
+        }
+    }
+
+    if (argHullSolver)
+    {
+        auto option = args::get(argHullSolver);
+        if (option == "ENVELOPE")
+        {
+            params.hullSolver = lad::HullSolver::HULL_ENVELOPE;
+            logc.warn("main-config", "Using upper envelope convex hull solver");
+        }
+        else if (option == "CGAL")
+            params.hullSolver = lad::HullSolver::HULL_CGAL;
+        else
+        {
+            logc.error("main-config", "Unknown convex hull solver");
+            return -1;
+        }
+    }
+
+    if (argTileSize)
+        params.tileSize = args::get(argTileSize);
+    if (argPointBudget)
+        params.pointBudget = args::get(argPointBudget);
+    if (argSlopeScreening)
+        params.slopeScreening = args::get(argSlopeScreening);
+    if (argExclusionGating)
+        params.exclusionGating = true;
+    if (argMeasurability)
+        params.measurability = true;
+    if (argQuantizationStep)
+        params.quantizationStep = args::get(argQuantizationStep);
+    if (argAutotune)
+        params.autotune = true;
+
+    int simdIsa = lad::ISA_AUTO;
+    if (argSimdIsa)
+    {
+        simdIsa = lad::parseSimdIsa(args::get(argSimdIsa).c_str());
+        if (simdIsa < lad::ISA_AUTO)
+        {
+            logc.error("main-config", "Unknown SIMD instruction set");
+            return -1;
+        }
+    }
+    int selectedIsa = lad::setSimdIsa(simdIsa); // before any worker thread is spawned
+    if (simdIsa > lad::ISA_AUTO && selectedIsa != simdIsa)
+    {
+        s << "Instruction set " << lad::getSimdIsaName(simdIsa) << " not supported, using " << lad::getSimdIsaName(selectedIsa);
+        logc.warn("main-config", s);
+    }
+
     if (argMetacenter)
         params.ratioMeta = args::get(argMetacenter);
     if (argSaveIntermediate)
@@ -210,6 +318,7 @@ int main(int argc, char *argv[])
         cout << "Output path:  \t" << outputFilePath << endl;
         lad::printParams(&params);
         cout << "Verbose level:\t\t" << params.verbosity << endl;
+        cout << "SIMD kernels:\t\t" << lad::getSimdIsaName(selectedIsa) << endl;
         cout << "Multithreaded version, max concurrent threads: [" << yellow << nThreads << reset << "]" << endl;
         cout << yellow << "*************************************************" << reset << endl
              << endl;
@@ -230,6 +339,10 @@ int main(int argc, char *argv[])
 
     pipeline.setTemplate("M1_RAW_Bathymetry"); // M1 will be used as internal template for the pipeline
     pipeline.extractContours("M1_VALID_DataMask", "M1_CONTOUR_Mask", params.verbosity);
+    if (params.slopeScreening > 0 && params.slopeAlgorithm != lad::FilterType::FILTER_CONVEX_SLOPE)
+        logc.warn("main", "Slope screening ignored, it only applies to the convex hull slope (FILTER_CONVEX_SLOPE)");
+    if (params.slopeAlgorithm == lad::FilterType::FILTER_CONVEX_SLOPE && params.hullSweep)
+        pipeline.computeHullCandidates("M1_RAW_Bathymetry", "M1_UPPER_HullCand", "M1_LOWER_HullCand"); // heading independent, once per map
     if (argSaveIntermediate)
     {
         pipeline.exportLayer("M1_RAW_Bathymetry", outputFileName + "M1_RAW_Bathymetry.tif", FMT_TIFF, WORLD_COORDINATE);
@@ -240,6 +353,7 @@ int main(int argc, char *argv[])
     pipeline.createKernelTemplate("KernelSlope", 0.1, 0.1, cv::MORPH_ELLIPSE); // TODO: convert this into a size/resolution aware method
     pipeline.createKernelTemplate("KernelDiag", params.robotDiagonal, params.robotDiagonal, cv::MORPH_ELLIPSE);
     dynamic_pointer_cast<KernelLayer>(pipeline.getLayer("KernelAUV"))->setRotation(params.rotation); // only useful for starting fixed rotation
+    pipeline.padLayer("M1_RAW_Bathymetry", "KernelAUV"); // NODATA halo, so border windows of every heading are read unclipped
 
     pipeline.computeExclusionMap("M1_VALID_DataMask", "KernelAUV", "C1_ExclusionMap"); // binary no-data exclusion mask
     if (argSaveIntermediate)
@@ -248,6 +362,48 @@ int main(int argc, char *argv[])
     }
     tt.lap("Load M1, C1");
 
+    // short calibration of the window filter strategy, before any heading uses it. The window engine only selects how the
+    // least-squares slope is evaluated, the other slope algorithms have a single strategy
+    if (params.autotune && params.slopeAlgorithm != lad::FilterType::FILTER_SLOPE)
+        logc.warn("main", "Autotune skipped, it only applies to the least-squares slope (FILTER_SLOPE)");
+    else if (params.autotune)
+    {
+        std::vector<double> headings;
+        if (params.fixRotation)
+            headings.push_back(params.rotation);
+        else
+            for (int r = 0; r <= (int)((params.rotationMax - params.rotationMin) / params.rotationStep); r++)
+                headings.push_back(params.rotationMin + r * params.rotationStep);
+        lad::AutotuneChoice choice;
+        if (pipeline.autotuneWindowFilter("M1_RAW_Bathymetry", "KernelAUV", headings, &choice) == NO_ERROR)
+        {
+            params.windowEngine = pipeline.parameters.windowEngine;
+            params.tileSize = pipeline.parameters.tileSize;
+            s << "Autotune [" << (choice.cached ? "cached" : "measured") << "]: engine " << yellow << (choice.windowEngine == lad::ENGINE_GATHER ? "GATHER" : "MOMENTS")
+              << reset << ", tile size " << yellow << choice.tileSize << reset << " px (" << choice.seconds << " s per heading on the sample)";
+            logc.info("main", s);
+        }
+        tt.lap("Autotune");
+    }
+
+    // terrain descriptors share a single gather pass, over the vehicle footprint or a square window of user defined size
+    if (argDescriptors)
+    {
+        std::string kernel = "KernelAUV";
+        if (argDescriptorSize)
+        {
+            double size = args::get(argDescriptorSize);
+            pipeline.createKernelTemplate("KernelDescriptor", size, size, cv::MORPH_RECT);
+            kernel = "KernelDescriptor";
+        }
+        if (pipeline.computeTerrainDescriptorMaps("M1_RAW_Bathymetry", kernel, "M1_VALID_DataMask") == NO_ERROR)
+        {
+            for (auto name : {"T1_Slope", "T2_TRI", "T3_TPI", "T4_Roughness", "T5_Curvature"})
+                pipeline.exportLayer(name, outputFileName + name + ".tif", FMT_TIFF, WORLD_COORDINATE);
+        }
+        tt.lap("Terrain descriptors T1-T5");
+    }
+
     // std::thread threadLaneA (&lad::processLaneA, &pipeline, &params, ""); //no suffix, nill-rotation sample
     // std::thread threadLaneB (&lad::processLaneB, &pipeline, &params, "");
 
@@ -358,6 +514,33 @@ int main(int argc, char *argv[])
         nIter = (params.rotationMax - params.rotationMin) / params.rotationStep;
     }
 
+    // The plane-fitting slope of every heading only depends on the rotated footprint, so it can be evaluated for the
+    // whole rotation sweep in a single pass over the raster. Lane C will reuse the resulting C2_MeanSlope_rXXX layers.
+    // The plane cache changes how lane C evaluates the slope, so it keeps the per heading path.
+    // The exclusion gating mask (C1_ExclusionMap, see getWindowMask) does not depend on the heading
+    if (params.slopeAlgorithm == lad::FilterType::FILTER_SLOPE && params.windowEngine == lad::WindowEngine::ENGINE_MOMENTS &&
+        params.planeCache.empty())
+    {
+        std::vector<std::string> kernels, slopes;
+        for (int nK = 0; nK <= nIter; nK++)
+        {
+            double rotation = params.rotationMin + nK * params.rotationStep;
+            string suffix = "_r" + makeFixedLength((int)rotation, 3);
+            if (pipeline.isAvailable("KernelAUV" + suffix))
+            {
+                pipeline.createKernelTemplate("KernelAUV" + suffix, params.robotWidth, params.robotLength, cv::MORPH_RECT);
+                dynamic_pointer_cast<KernelLayer>(pipeline.getLayer("KernelAUV" + suffix))->setRotation(rotation);
+            }
+            kernels.push_back("KernelAUV" + suffix);
+            slopes.push_back("C2_MeanSlope" + suffix);
+        }
+        std::string mask = params.exclusionGating ? "C1_ExclusionMap" : "M1_VALID_DataMask";
+        if (pipeline.applyWindowFilter("M1_RAW_Bathymetry", kernels, mask, slopes, FILTER_SLOPE) != NO_ERROR)
+            for (auto &slope : slopes) // lane C falls back to the per heading filter
+                pipeline.removeLayer(slope);
+        tt.lap("** C2 batched slope");
+    }
+
     int finished = 0;
 
 #pragma omp parallel for shared(finished) num_threads(nThreads)
@@ -396,26 +579,35 @@ int main(int argc, char *argv[])
 
     pipeline.createLayer("M3_LandabilityMap_BLEND", LAYER_RASTER);
     pipeline.copyMask("M1_RAW_Bathymetry", "M3_LandabilityMap_BLEND");
-    // pipeline.createLayer("M4_FinalMeasurability_BLEND", LAYER_RASTER);
-    // pipeline.copyMask("M1_RAW_Bathymetry", "M4_FinalMeasurability_BLEND");
+    if (params.measurability)
+    {
+        pipeline.createLayer("M4_FinalMeasurability_BLEND", LAYER_RASTER);
+        pipeline.copyMask("M1_RAW_Bathymetry", "M4_FinalMeasurability_BLEND");
+    }
     pipeline.createLayer("C2_MeanSlope_BLEND", LAYER_RASTER);
     pipeline.copyMask("M1_RAW_Bathymetry", "C2_MeanSlope_BLEND");
 
     auto apBase = dynamic_pointer_cast<RasterLayer>(pipeline.getLayer("M1_RAW_Bathymetry"));
     auto apFinal = dynamic_pointer_cast<RasterLayer>(pipeline.getLayer("M3_LandabilityMap_BLEND"));
-    // auto apMeasure = dynamic_pointer_cast<RasterLayer>(pipeline.getLayer("M4_FinalMeasurability_BLEND"));
+    auto apMeasure = dynamic_pointer_cast<RasterLayer>(pipeline.getLayer("M4_FinalMeasurability_BLEND"));
     auto apSlope = dynamic_pointer_cast<RasterLayer>(pipeline.getLayer("C2_MeanSlope_BLEND"));
 
     apFinal->copyGeoProperties(apBase);
-    apFinal->setNoDataValue(DEFAULT_NODATA_VALUE);
-    // apMeasure->copyGeoProperties(apBase);
-    // apMeasure->setNoDataValue(DEFAULT_NODATA_VALUE);
-    apSlope->copyGeoProperties(apBase);
-    apSlope->setNoDataValue(DEFAULT_NODATA_VALUE);
-
-    apFinal->rasterData = cv::Mat(apBase->rasterData.size(), CV_64FC1, DEFAULT_NODATA_VALUE); // NODATA raster, then we upload the values
-    // apMeasure->rasterData = cv::Mat(apBase->rasterData.size(), CV_64FC1, DEFAULT_NODATA_VALUE); // NODATA raster, then we upload the values
-    apSlope->rasterData = cv::Mat(apBase->rasterData.size(), CV_64FC1, DEFAULT_NODATA_VALUE); // NODATA raster, then we upload the values
+    apFinal->setNoDataValue(RASTER_NODATA);
+    if (apMeasure != nullptr)
+    {
+        apMeasure->copyGeoProperties(apBase);
+        apMeasure->setNoDataValue(RASTER_NODATA);
+        apMeasure->rasterData = cv::Mat(apBase->rasterData.size(), CV_64FC1, RASTER_NODATA); // NODATA raster, then we upload the values
+    }
+    if (apSlope != nullptr)
+    {
+        apSlope->copyGeoProperties(apBase);
+        apSlope->setNoDataValue(RASTER_NODATA);
+        apSlope->rasterData = cv::Mat(apBase->rasterData.size(), CV_64FC1, RASTER_NODATA); // NODATA raster, then we upload the values
+    }
+
+    apFinal->rasterData = cv::Mat(apBase->rasterData.size(), CV_64FC1, RASTER_NODATA); // NODATA raster, then we upload the values
     cv::Mat acum = cv::Mat::zeros(apBase->rasterData.size(), CV_64FC1);                       // acumulator matrix
 
     // pipeline.showInfo();
@@ -449,76 +641,40 @@ int main(int argc, char *argv[])
 
     logc.info("main", "Exporting M3_LandabilityMap_BLEND");
     // transfer, via mask
-    acum.copyTo(apFinal->rasterData, apFinal->rasterMask); // dst.rasterData use non-null values as binary mask ones
+    acum.copyTo(apFinal->rasterData, apFinal->getMask()); // dst.rasterData use non-null values as binary mask ones
 
     pipeline.saveImage("M3_LandabilityMap_BLEND", outputFileName + "M3_LandabilityMap_BLEND.png");
     pipeline.exportLayer("M3_LandabilityMap_BLEND", outputFileName + "M3_LandabilityMap_BLEND.tif", FMT_TIFF, WORLD_COORDINATE);
     //*******************************************************//
-    // acum = cv::Mat::zeros(apBase->rasterData.size(), CV_64FC1); // acumulator matrix
-    // for (int r=0; r<=nIter; r++){
-    //     double currRotation = params.rotationMin + r*params.rotationStep;
-    //     s <<  "Current orientation [" << cyan << currRotation << reset << "] degrees. Blending [" << yellow << r << "/" << nIter << reset << "]";
-    //     logc.info("main",s);
-    //     // params.rotation = currRotation;
-    //     string suffix = "_r" + makeFixedLength((int) currRotation, 3);
-    //     string currentname = "M4_FinalMeasurability" + suffix;
-    //     // if (params.exportRotated)
-    //     //     pipeline.saveImage(currentname, currentname + ".png");
-    //     // cout << "\tName: " << currentname << endl;
-    //     // let's retrieve the rasterData for the current orientation layer
-    //     auto apCurrent = dynamic_pointer_cast<RasterLayer>(pipeline.getLayer(currentname));
-    //     if (apCurrent == nullptr){
-    //         s << "Failed to retrieve layer apCurrent [ " << currentname << "], line: " << __LINE__;
-    //         logc.error("M4-blend", s);
-    //     }        // let's convert to a CV64FC1 normalized matrix. This may not be necessary if layer data already stored as CV64FC1
-    //     cv::Mat currentmat;
-    //     apCurrent->rasterData.convertTo(currentmat, CV_64FC1);
-    //     acum = acum + currentmat; // sum to the acum
-    // }
-
-    // logc.info("main", "Blending all rotation-depending MAD-maps (M4)...");
-    // logc.info("main", "Normalizing...");
-    // acum = acum / (nIter+1);    //normalizing
-    // logc.info("main", "Exporting M4_FinalMeasurability_BLEND");
-    // // transfer, via mask
-    // acum.copyTo(apMeasure->rasterData, apFinal->rasterMask); // dst.rasterData use non-null values as binary mask ones
-
-    // pipeline.saveImage("M4_FinalMeasurability_BLEND", outputFileName + "M4_FinalMeasurability_BLEND.png");
-    // pipeline.exportLayer("M4_FinalMeasurability_BLEND", outputFileName + "M4_FinalMeasurability_BLEND.tif", FMT_TIFF, WORLD_COORDINATE);
+    // the measurability of a heading is NODATA where its window could not be evaluated, only valid headings are blended
+    if (apMeasure != nullptr)
+    {
+        logc.info("main", "Blending all rotation-depending MAD-maps (M4)...");
+        cv::Mat blend;
+        if (blendRotatedLayers(pipeline, params, nIter, "M4_FinalMeasurability", blend) == NO_ERROR)
+        {
+            logc.info("main", "Exporting M4_FinalMeasurability_BLEND");
+            // transfer, via mask
+            blend.copyTo(apMeasure->rasterData, apFinal->getMask()); // dst.rasterData use non-null values as binary mask ones
+            pipeline.saveImage("M4_FinalMeasurability_BLEND", outputFileName + "M4_FinalMeasurability_BLEND.png");
+            pipeline.exportLayer("M4_FinalMeasurability_BLEND", outputFileName + "M4_FinalMeasurability_BLEND.tif", FMT_TIFF, WORLD_COORDINATE);
+        }
+    }
     //*******************************************************//
-    acum = cv::Mat::zeros(apBase->rasterData.size(), CV_64FC1); // acumulator matrix
-    for (int r = 0; r <= nIter; r++)
+    // Windows that were not evaluated (NODATA, e.g. skipped by the exclusion gating) are left out of the blend
+    if (apSlope != nullptr)
     {
-        double currRotation = params.rotationMin + r * params.rotationStep;
-        s << "Current orientation [" << cyan << currRotation << reset << "] degrees. Blending [" << yellow << r << "/" << nIter << reset << "]";
-        logc.info("main", s);
-        // params.rotation = currRotation;
-        string suffix = "_r" + makeFixedLength((int)currRotation, 3);
-        string currentname = "C2_MeanSlope" + suffix;
-        // if (params.exportRotated)
-        //     pipeline.saveImage(currentname, currentname + ".png");
-        // cout << "\tName: " << currentname << endl;
-        // let's retrieve the rasterData for the current orientation layer
-        auto apCurrent = dynamic_pointer_cast<RasterLayer>(pipeline.getLayer(currentname));
-        if (apCurrent == nullptr)
+        logc.info("main", "Blending all rotation-depending Slope-maps (C2)...");
+        cv::Mat blend;
+        if (blendRotatedLayers(pipeline, params, nIter, "C2_MeanSlope", blend) == NO_ERROR)
         {
-            s << "Failed to retrieve layer apCurrent [ " << currentname << "], line: " << __LINE__;
-            logc.error("C2-blend", s);
-        } // let's convert to a CV64FC1 normalized matrix. This may not be necessary if layer data already stored as CV64FC1
-        cv::Mat currentmat;
-        apCurrent->rasterData.convertTo(currentmat, CV_64FC1);
-        acum = acum + currentmat; // sum to the acum
+            logc.info("main", "Exporting C2_MeanSlope_BLEND");
+            // transfer, via mask
+            blend.copyTo(apSlope->rasterData, apFinal->getMask()); // dst.rasterData use non-null values as binary mask ones
+            pipeline.saveImage("C2_MeanSlope_BLEND", outputFileName + "C2_MeanSlope_BLEND.png");
+            pipeline.exportLayer("C2_MeanSlope_BLEND", outputFileName + "C2_MeanSlope_BLEND.tif", FMT_TIFF, WORLD_COORDINATE);
+        }
     }
-
-    logc.info("main", "Blending all rotation-depending Slope-maps (C2)...");
-    logc.info("main", "Normalizing...");
-    acum = acum / (nIter + 1); // normalizing
-    logc.info("main", "Exporting C2_MeanSlope_BLEND");
-    // transfer, via mask
-    acum.copyTo(apSlope->rasterData, apFinal->rasterMask); // dst.rasterData use non-null values as binary mask ones
-
-    pipeline.saveImage("C2_MeanSlope_BLEND", outputFileName + "C2_MeanSlope_BLEND.png");
-    pipeline.exportLayer("C2_MeanSlope_BLEND", outputFileName + "C2_MeanSlope_BLEND.tif", FMT_TIFF, WORLD_COORDINATE);
     //*******************************************************//
     if (params.verbosity > 1)
         pipeline.showInfo();
@@ -395,7 +395,7 @@ int main(int argc, char *argv[])
 
     logc.info("main","Exporting M3_LandabilityMap_BLEND");
     // transfer, via mask
-    acum.copyTo(apFinal->rasterData, apFinal->rasterMask); // dst.rasterData use non-null values as binary mask ones
+    acum.copyTo(apFinal->rasterData, apFinal->getMask()); // dst.rasterData use non-null values as binary mask ones
 
     pipeline.saveImage("M3_LandabilityMap_BLEND", outputFileName + "M3_LandabilityMap_BLEND.png");
     pipeline.exportLayer("M3_LandabilityMap_BLEND", outputFileName + "M3_LandabilityMap_BLEND.tif", FMT_TIFF, WORLD_COORDINATE);
@@ -427,7 +427,7 @@ int main(int argc, char *argv[])
     acum = acum / (nIter+1);    //normalizing
     logc.info("main", "Exporting M4_FinalMeasurability_BLEND");
     // transfer, via mask
-    acum.copyTo(apMeasure->rasterData, apFinal->rasterMask); // dst.rasterData use non-null values as binary mask ones
+    acum.copyTo(apMeasure->rasterData, apFinal->getMask()); // dst.rasterData use non-null values as binary mask ones
 
     pipeline.saveImage("M4_FinalMeasurability_BLEND", outputFileName + "M4_FinalMeasurability_BLEND.png");
     pipeline.exportLayer("M4_FinalMeasurability_BLEND", outputFileName + "M4_FinalMeasurability_BLEND.tif", FMT_TIFF, WORLD_COORDINATE);
@@ -459,7 +459,7 @@ int main(int argc, char *argv[])
     acum = acum / (nIter+1);    //normalizing
     logc.info("main", "Exporting C2_MeanSlope_BLEND");
     // transfer, via mask
-    acum.copyTo(apSlope->rasterData, apFinal->rasterMask); // dst.rasterData use non-null values as binary mask ones
+    acum.copyTo(apSlope->rasterData, apFinal->getMask()); // dst.rasterData use non-null values as binary mask ones
 
     pipeline.saveImage("C2_MeanSlope_BLEND", outputFileName + "C2_MeanSlope_BLEND.png");
     pipeline.exportLayer("C2_MeanSlope_BLEND", outputFileName + "C2_MeanSlope_BLEND.tif", FMT_TIFF, WORLD_COORDINATE);
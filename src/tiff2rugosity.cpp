@@ -137,10 +137,10 @@ int main(int argc, char *argv[])
 
     for (int j=0; j<dst.rows-1; j++){   // last row is replicated
         for (int i=0; i<dst.cols-1; i++){ // last column is replicated
-            a.z = apLayer->rasterData.at<double>(Point2i(i,  j));
-            b.z = apLayer->rasterData.at<double>(Point2i(i+1,j));
-            c.z = apLayer->rasterData.at<double>(Point2i(i+1,j+1));
-            d.z = apLayer->rasterData.at<double>(Point2i(i  ,j+1)); // four corners
+            a.z = apLayer->rasterData.at<raster_t>(Point2i(i,  j));
+            b.z = apLayer->rasterData.at<raster_t>(Point2i(i+1,j));
+            c.z = apLayer->rasterData.at<raster_t>(Point2i(i+1,j+1));
+            d.z = apLayer->rasterData.at<raster_t>(Point2i(i  ,j+1)); // four corners
             // if (any of the additional points) is (nodata), invalidate calculation
             if ((a.z==nd) || (b.z==nd) || (c.z==nd) || (d.z==nd)){ // nodata, invalidate calculation
                 dst.at<double>(Point2i(i,j)) = nd; //
@@ -175,7 +175,7 @@ int main(int argc, char *argv[])
         cv::Mat original;
         apLayer->rasterData.copyTo(original);
         namedWindow ("original");
-        cv::normalize(original, original, 0, 255, NORM_MINMAX, CV_8UC1, apLayer->rasterMask); // normalize within the expected range 0-255 for imshow
+        cv::normalize(original, original, 0, 255, NORM_MINMAX, CV_8UC1, apLayer->getMask()); // normalize within the expected range 0-255 for imshow
         imshow("original", original);
 
         cv::Mat normalized;
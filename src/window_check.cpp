@@ -0,0 +1,373 @@
+/**
+ * @file window_check.cpp
+ * @author Jose Cappelletto (cappelletto@gmail.com)
+ * @brief Consistency check of the window filter engines on synthetic rasters. The fast paths (moment tables, ...) are
+ * compared against the gathering engine, which fits the points of every window with CGAL and is kept as the reference
+ * implementation. Every check reports its largest deviation, and the exit code is the number of failed checks
+ * @version 0.1
+ * @date 2024-03-18
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "headers.h"
+#include "helper.h"
+
+#include "lad_core.hpp"
+#include "lad_config.hpp"
+#include "lad_enum.hpp"
+#include "lad_processing.hpp"
+#include "lad_window.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace lad;
+
+logger::ConsoleOutput logc;
+
+// largest deviation accepted between the fast paths and the reference ones, see MomentTable
+const double SLOPE_TOLERANCE = 1e-6; // [deg]
+const double MEAN_TOLERANCE = 1e-6;  // [m]
+
+/**
+ * @brief Synthetic bathymetry: a tilted undulating seafloor at ~40 m depth. Optionally, a random fraction of the samples
+ * and a rectangular block are set to NODATA, so the windows of the engines see partially empty footprints
+ *
+ * @param rows Number of rows of the raster
+ * @param cols Number of columns of the raster
+ * @param sx Horizontal pixel resolution [m]
+ * @param sy Vertical pixel resolution [m]
+ * @param holes Fraction of random NODATA samples, zero for a fully valid raster
+ * @return cv::Mat Raster of RASTER_TYPE
+ */
+cv::Mat createSurface(int rows, int cols, double sx, double sy, double holes)
+{
+    cv::Mat raster(rows, cols, RASTER_TYPE);
+    cv::RNG rng(0x1ad);
+    for (int row = 0; row < rows; row++)
+    {
+        for (int col = 0; col < cols; col++)
+        {
+            double x = col * sx;
+            double y = row * fabs(sy);
+            double z = -40.0 + 0.12 * x - 0.05 * y + 0.4 * sin(0.9 * x) * cos(0.6 * y) + 0.05 * sin(3.1 * x + 2.3 * y);
+            raster.at<raster_t>(row, col) = (raster_t)z;
+        }
+    }
+    if (holes > 0)
+    {
+        for (int row = 0; row < rows; row++)
+            for (int col = 0; col < cols; col++)
+                if (rng.uniform(0.0, 1.0) < holes)
+                    raster.at<raster_t>(row, col) = RASTER_NODATA;
+        raster(cv::Rect(cols / 3, rows / 4, cols / 5, rows / 6)).setTo(RASTER_NODATA);
+    }
+    return raster;
+}
+
+/**
+ * @brief Insert a raster layer and its valid data mask in the pipeline, as readTIFF does for a geoTIFF file
+ *
+ * @param pipeline Destination pipeline
+ * @param raster Raster samples
+ * @param name Name of the raster layer
+ * @param mask Name of the valid data mask layer
+ * @return int Error code, if any
+ */
+int loadSurface(lad::Pipeline &pipeline, const cv::Mat &raster, std::string name, std::string mask)
+{
+    pipeline.createLayer(name, LAYER_RASTER);
+    pipeline.createLayer(mask, LAYER_RASTER);
+    auto apRaster = dynamic_pointer_cast<RasterLayer>(pipeline.getLayer(name));
+    auto apMask = dynamic_pointer_cast<RasterLayer>(pipeline.getLayer(mask));
+    if (apRaster == nullptr || apMask == nullptr)
+        return LAYER_NOT_FOUND;
+    apRaster->rasterData = raster.clone();
+    apRaster->setNoDataValue(RASTER_NODATA);
+    for (int i = 0; i < 6; i++)
+        apRaster->transformMatrix[i] = pipeline.geoTransform[i];
+    apRaster->layerDimensions[0] = raster.cols;
+    apRaster->layerDimensions[1] = raster.rows;
+    apRaster->updateMask();
+    apRaster->updateStats();
+    apRaster->getMask().copyTo(apMask->rasterData);
+    apMask->setMask(apRaster->getMask());
+    apMask->copyGeoProperties(apRaster);
+    apMask->setNoDataValue(DEFAULT_NODATA_VALUE);
+    return NO_ERROR;
+}
+
+/**
+ * @brief Compare two raster layers of the pipeline: their NODATA maps must be identical, and their valid samples agree
+ * within the tolerance
+ *
+ * @param pipeline Pipeline containing both layers
+ * @param test Layer under test
+ * @param reference Reference layer
+ * @param tolerance Largest deviation accepted
+ * @param label Description of the check, printed along its result
+ * @return int Number of failed checks (0 or 1)
+ */
+int compareLayers(lad::Pipeline &pipeline, std::string test, std::string reference, double tolerance, std::string label)
+{
+    auto apTest = dynamic_pointer_cast<RasterLayer>(pipeline.getLayer(test));
+    auto apRef = dynamic_pointer_cast<RasterLayer>(pipeline.getLayer(reference));
+    if (apTest == nullptr || apRef == nullptr || apTest->rasterData.size() != apRef->rasterData.size())
+    {
+        cout << red << "[FAIL] " << reset << label << ": missing output layer" << endl;
+        return 1;
+    }
+    int nValid = 0, nMismatch = 0;
+    double maxDev = 0;
+    for (int row = 0; row < apRef->rasterData.rows; row++)
+    {
+        for (int col = 0; col < apRef->rasterData.cols; col++)
+        {
+            double t = apTest->rasterData.at<raster_t>(row, col);
+            double r = apRef->rasterData.at<raster_t>(row, col);
+            bool tValid = !isNoData(t, apTest->getNoDataValue());
+            bool rValid = !isNoData(r, apRef->getNoDataValue());
+            if (tValid != rValid)
+                nMismatch++;
+            else if (rValid)
+            {
+                nValid++;
+                maxDev = std::max(maxDev, fabs(t - r));
+            }
+        }
+    }
+    bool ok = (nMismatch == 0 && nValid > 0 && maxDev <= tolerance);
+    cout << (ok ? green : red) << (ok ? "[ OK ] " : "[FAIL] ") << reset << label << ": " << nValid << " windows, max deviation "
+         << maxDev << " (tolerance " << tolerance << "), " << nMismatch << " NODATA mismatches" << endl;
+    return ok ? 0 : 1;
+}
+
+/**
+ * @brief Closed-form eigen-solver of the moment engine (scalar and batched SIMD slopes) against the CGAL fit of the
+ * gathering engine, on degenerate point clouds. Where the fitting plane is unique both slopes must agree, otherwise
+ * (collinear or isotropic points) any finite unit normal is accepted
+ *
+ * @return int Number of failed checks
+ */
+int checkDegeneratePlanes()
+{
+    typedef struct planeCase_
+    {
+        std::string name;
+        std::vector<KPoint> points;
+        bool unique; // the least-squares plane is unique
+    } PlaneCase;
+    std::vector<PlaneCase> cases;
+    cv::RNG rng(0x5eed);
+    std::vector<KPoint> points;
+    for (int i = 0; i < 12; i++) // single row of samples along a slope: rank 1 covariance
+        points.push_back(KPoint(0.1 * i, 0, -40 + 0.03 * i));
+    cases.push_back({"collinear samples", points, false});
+    points.clear();
+    for (int i = 0; i < 12; i++) // single row of samples with scattered elevation: vertical plane
+        points.push_back(KPoint(0.1 * i, 0, -40 + rng.uniform(-0.2, 0.2)));
+    cases.push_back({"vertical plane", points, true});
+    points.clear();
+    for (int i = -1; i <= 1; i += 2) // cube corners: isotropic covariance, three repeated eigenvalues
+        for (int j = -1; j <= 1; j += 2)
+            for (int k = -1; k <= 1; k += 2)
+                points.push_back(KPoint(i, j, -40 + k));
+    cases.push_back({"isotropic cloud", points, false});
+    points.clear();
+    for (int r = 0; r < 7; r++) // flat square window: repeated largest eigenvalues
+        for (int c = 0; c < 7; c++)
+            points.push_back(KPoint(0.1 * c, 0.1 * r, -40));
+    cases.push_back({"flat square", points, true});
+    points.clear();
+    for (int r = 0; r < 7; r++) // cliff: near-vertical plane
+        for (int c = 0; c < 7; c++)
+            points.push_back(KPoint(0.1 * c, 0.1 * r, -40 + 400 * 0.1 * c + rng.uniform(-1e-4, 1e-4)));
+    cases.push_back({"near-vertical plane", points, true});
+    points.clear();
+    for (int r = 0; r < 7; r++) // regular tilted and rough window
+        for (int c = 0; c < 7; c++)
+            points.push_back(KPoint(0.1 * c, 0.1 * r, -40 + 0.03 * c - 0.02 * r + rng.uniform(-0.01, 0.01)));
+    cases.push_back({"tilted plane", points, true});
+
+    // moments in world units (unit pixel scale). The batch is replicated so that every SIMD lane width is exercised
+    const int nCopies = 4;
+    std::vector<PlaneMoments> moments;
+    for (int k = 0; k < nCopies; k++)
+    {
+        for (auto &pc : cases)
+        {
+            PlaneMoments m = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+            for (auto &q : pc.points)
+            {
+                m.n++;
+                m.x += q.x();
+                m.y += q.y();
+                m.z += q.z();
+                m.xx += q.x() * q.x();
+                m.yy += q.y() * q.y();
+                m.zz += q.z() * q.z();
+                m.xy += q.x() * q.y();
+                m.xz += q.x() * q.z();
+                m.yz += q.y() * q.z();
+            }
+            moments.push_back(m);
+        }
+    }
+    std::vector<double> batched(moments.size());
+    computeMomentSlopes(moments.data(), (int)moments.size(), 1.0, 1.0, batched.data());
+
+    int nFailed = 0;
+    for (int i = 0; i < cases.size(); i++)
+    {
+        double normal[3];
+        computeMomentNormal(moments[i], 1.0, 1.0, normal);
+        double slope = computeMomentSlope(moments[i], 1.0, 1.0);
+        double slopeCGAL = computePlaneSlope(computeFittingPlane(cases[i].points), KVector(0, 0, 1));
+        double maxDev = 0;
+        for (int k = 0; k < nCopies; k++)
+            maxDev = std::max(maxDev, fabs(batched[k * cases.size() + i] - slope));
+        bool ok;
+        if (cases[i].unique)
+            ok = (fabs(slope - slopeCGAL) <= SLOPE_TOLERANCE && maxDev <= SLOPE_TOLERANCE);
+        else
+        {
+            double norm = sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            ok = (std::isfinite(norm) && fabs(norm - 1) < 1e-9 && std::isfinite(slopeCGAL));
+        }
+        cout << (ok ? green : red) << (ok ? "[ OK ] " : "[FAIL] ") << reset << "Plane fit, " << cases[i].name << ": closed-form "
+             << slope << " deg, batched deviation " << maxDev << ", CGAL " << slopeCGAL << " deg" << (cases[i].unique ? "" : " (not unique)")
+             << endl;
+        nFailed += !ok;
+    }
+    return nFailed;
+}
+
+/**
+ * @brief Upper envelope solver against the complete CGAL hull, both queried at the nudged point of the envelope solver
+ * (ENVELOPE_QUERY_NUDGE), on the windows of a raster layer anchored on a regular grid. Windows where the envelope solver
+ * does not converge are only counted, as computeConvexHullPlane falls back to CGAL for them
+ *
+ * @param pipeline Pipeline containing the layers
+ * @param raster Name of the raster layer
+ * @param kernel Name of the kernel layer
+ * @return int Number of failed checks (0 or 1)
+ */
+int checkHullSolvers(lad::Pipeline &pipeline, std::string raster, std::string kernel)
+{
+    auto apSrc = dynamic_pointer_cast<RasterLayer>(pipeline.getLayer(raster));
+    auto apKernel = dynamic_pointer_cast<KernelLayer>(pipeline.getLayer(kernel));
+    const cv::Mat &data = apSrc->rasterData;
+    double nodata = apSrc->getNoDataValue();
+    double sx = pipeline.geoTransform[1];
+    double sy = pipeline.geoTransform[5];
+    KernelFootprint window = apKernel->bank.window;
+    window.setStride(data.step1(), getRasterHalo(data));
+    double qx = 0.0001 + ENVELOPE_QUERY_NUDGE;
+    double qy = 0.0001 - ENVELOPE_QUERY_NUDGE;
+    int nWindows = 0, nFallback = 0;
+    double maxDev = 0;
+    for (int row = 0; row < data.rows; row += 3)
+    {
+        for (int col = 0; col < data.cols; col += 3)
+        {
+            if (isNoData(data.at<raster_t>(row, col), nodata))
+                continue;
+            vector<KPoint> points, sensor;
+            double acum = 0;
+            gatherFootprintPoints(data, nodata, row, col, window, data.rows, data.cols, row, col, sx, sy, points, &acum, sensor, 0);
+            if (points.size() <= 5) // same minimum number of points required by the filter
+                continue;
+            KVector zmean(0, 0, acum / points.size());
+            for (auto &p : points)
+                p = p - zmean;
+            KPlane envelope;
+            if (computeUpperEnvelopePlane(points, envelope, qx, qy) == ERROR_NOT_CONVERGED)
+            {
+                nFallback++;
+                continue;
+            }
+            KPlane reference = computeConvexHullPlaneCGAL(points, qx, qy);
+            double dev = fabs(computePlaneSlope(envelope, KVector(0, 0, 1)) - computePlaneSlope(reference, KVector(0, 0, 1)));
+            maxDev = std::max(maxDev, dev);
+            nWindows++;
+        }
+    }
+    bool ok = (nWindows > 0 && maxDev <= SLOPE_TOLERANCE);
+    cout << (ok ? green : red) << (ok ? "[ OK ] " : "[FAIL] ") << reset << "Envelope vs CGAL hull, " << raster << ": " << nWindows
+         << " windows, max deviation " << maxDev << " deg (tolerance " << SLOPE_TOLERANCE << "), " << nFallback << " CGAL fallbacks" << endl;
+    return ok ? 0 : 1;
+}
+
+/*!
+    @fn     int main(int argc, char* argv[])
+    @brief  Main function
+*/
+int main(int argc, char *argv[])
+{
+    cout << cyan << "window_check" << reset << endl;
+    int nFailed = 0;
+
+    lad::Pipeline pipeline;
+    pipeline.verbosity = NO_VERBOSE;
+    pipeline.useNodataMask = true;
+    pipeline.parameters.pointBudget = 0; // every sample of the window, as the moment tables do
+    double geoTransform[6] = {0, 0.1, 0, 0, 0, -0.1};
+    for (int i = 0; i < 6; i++)
+        pipeline.geoTransform[i] = geoTransform[i];
+    int rows = 160, cols = 160;
+    double sx = geoTransform[1], sy = geoTransform[5];
+
+    loadSurface(pipeline, createSurface(rows, cols, sx, sy, 0), "S1_Surface", "S1_Mask");
+    loadSurface(pipeline, createSurface(rows, cols, sx, sy, 0.15), "S2_Surface", "S2_Mask");
+    pipeline.createKernelTemplate("KernelAUV", 0.5, 1.4, cv::MORPH_RECT);
+    auto apKernel = dynamic_pointer_cast<KernelLayer>(pipeline.getLayer("KernelAUV"));
+
+    // moment tables against the gathering engine: rectangular and rotated kernels, with and without NODATA samples
+    for (std::string surface : {"S1", "S2"})
+    {
+        for (double heading : {0.0, 30.0})
+        {
+            apKernel->setRotation(heading);
+            ostringstream label;
+            label << surface << " @ " << heading << " deg";
+            for (auto filter : {std::make_pair(FILTER_SLOPE, SLOPE_TOLERANCE), std::make_pair(FILTER_MEAN, MEAN_TOLERANCE)})
+            {
+                string name = surface + (filter.first == FILTER_SLOPE ? "_Slope" : "_Mean");
+                pipeline.parameters.windowEngine = ENGINE_GATHER;
+                pipeline.applyWindowFilter(surface + "_Surface", "KernelAUV", surface + "_Mask", name + "_Gather", filter.first);
+                pipeline.parameters.windowEngine = ENGINE_MOMENTS;
+                pipeline.applyWindowFilter(surface + "_Surface", "KernelAUV", surface + "_Mask", name + "_Moments", filter.first);
+                nFailed += compareLayers(pipeline, name + "_Moments", name + "_Gather", filter.second,
+                                         (filter.first == FILTER_SLOPE ? "Moment slope, " : "Moment mean, ") + label.str());
+                pipeline.removeLayer(name + "_Gather");
+                pipeline.removeLayer(name + "_Moments");
+            }
+        }
+    }
+
+    // the GEOTECH moments path refuses to run without the moment table of the raster (see getMomentTable)
+    apKernel->setRotation(0);
+    pipeline.parameters.windowEngine = ENGINE_MOMENTS;
+    int r = pipeline.applyWindowFilter("S2_Surface", "KernelAUV", "S2_Mask", "S2_Geotech", FILTER_GEOTECH);
+    cout << (r == NO_ERROR ? green : red) << (r == NO_ERROR ? "[ OK ] " : "[FAIL] ") << reset << "Moment table available for GEOTECH" << endl;
+    nFailed += (r != NO_ERROR);
+
+    // upper envelope solver against the CGAL hull at the same query point, and the envelope sweep against the per-window
+    // envelope filter (the nudged facet does not depend on the candidate subset)
+    pipeline.parameters.hullSolver = HULL_ENVELOPE;
+    for (std::string surface : {"S1", "S2"})
+    {
+        nFailed += checkHullSolvers(pipeline, surface + "_Surface", "KernelAUV");
+        pipeline.parameters.hullSweep = false;
+        pipeline.applyWindowFilter(surface + "_Surface", "KernelAUV", surface + "_Mask", surface + "_Convex", FILTER_CONVEX_SLOPE);
+        pipeline.parameters.hullSweep = true;
+        pipeline.applyWindowFilter(surface + "_Surface", "KernelAUV", surface + "_Mask", surface + "_ConvexSweep", FILTER_CONVEX_SLOPE);
+        nFailed += compareLayers(pipeline, surface + "_ConvexSweep", surface + "_Convex", SLOPE_TOLERANCE, "Envelope sweep, " + surface);
+    }
+
+    // closed-form plane solver of the moment engine on the degenerate windows
+    nFailed += checkDegeneratePlanes();
+
+    cout << (nFailed ? red : green) << nFailed << " failed checks" << reset << endl;
+    return nFailed;
+}